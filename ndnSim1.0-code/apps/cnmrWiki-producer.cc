@@ -22,6 +22,8 @@
 
 #include "wiki-pagetitle.h"
 #include "cnmrWiki-producer.h"
+#include "hot-path-profiler.h"
+#include "event-log.h"
 #include "ns3/log.h"
 #include "ns3/ndn-interest.h"
 #include "ns3/ndn-data.h"
@@ -68,6 +70,10 @@ CnmrWikiProducer::GetTypeId (void)
                    UintegerValue (1024),
                    MakeUintegerAccessor (&CnmrWikiProducer::m_virtualPayloadSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSegments", "Max number of segments per title, if 1 (default), then titles are not segmented",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&CnmrWikiProducer::m_maxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("Freshness", "Freshness of data packets, if 0, then unlimited freshness",
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&CnmrWikiProducer::m_freshness),
@@ -85,6 +91,9 @@ CnmrWikiProducer::GetTypeId (void)
 }
 
 CnmrWikiProducer::CnmrWikiProducer ()
+  : m_maxSegments (1)
+  , m_servedInterests (0)
+  , m_unservedInterests (0)
 {
   // NS_LOG_FUNCTION_NOARGS ();
 }
@@ -116,6 +125,12 @@ CnmrWikiProducer::StartApplication ()
 
   NS_LOG_DEBUG ("NodeID: " << GetNode ()->GetId ());
 
+  MetricLabels labels = MetricsRegistry::NodeLabels (GetNode ()->GetId ());
+  labels.push_back (std::make_pair (std::string ("type"), std::string ("served")));
+  m_servedInterests = MetricsRegistry::Get ().AddCounter ("producer.interests", labels);
+  labels.back ().second = "unserved";
+  m_unservedInterests = MetricsRegistry::Get ().AddCounter ("producer.interests", labels);
+
   Ptr<Fib> fib = GetNode ()->GetObject<Fib> ();
 
   std::vector<Name>::iterator it;
@@ -141,22 +156,42 @@ CnmrWikiProducer::StopApplication ()
 void
 CnmrWikiProducer::OnInterest (Ptr<const Interest> interest)
 {
-  App::OnInterest (interest); // tracing inside
+  NDN_PROFILE_SCOPE ("CnmrWikiProducer", "OnInterest");
 
-  NS_LOG_FUNCTION (this << interest);
+  App::OnInterest (interest); // tracing inside
 
   if (!m_active) return;
 
 
   bool legitimateRequest = true;
   std::string seqName = interest->GetName ().get (-1).toBlob ();
-  NS_LOG_INFO("Received Interest for "<< seqName);
-  if(WikiPageTitles::Instance()->find(seqName) == -1)
+  uint32_t segment = 0;
+  bool segmented = m_maxSegments > 1 && interest->GetName ().size () > 1 &&
+    WikiPageTitles::parseSegment (seqName, segment);
+  if (segmented)
+    {
+      // segmented object, the title is the second to last component
+      seqName = interest->GetName ().get (-2).toBlob ();
+    }
+  EventLog::Record (EventLog::PRODUCER_INTEREST, GetNode ()->GetId (), m_face->GetId (), seqName, segment);
+
+  if (segmented)
+    {
+      int32_t index = WikiPageTitles::Instance()->find(seqName);
+      if (index == -1 || segment >= WikiPageTitles::Instance()->segments(index, m_maxSegments))
+        legitimateRequest = false;
+    }
+  else if(WikiPageTitles::Instance()->find(seqName) == -1)
     legitimateRequest = false;
 
   FwHopCountTag hopCountTag;
   interest->GetPayload ()->PeekPacketTag (hopCountTag);
 
+  if(legitimateRequest)
+    m_servedInterests->Inc ();
+  else
+    m_unservedInterests->Inc ();
+
   if(legitimateRequest)
   {
     Ptr<Data> data = Create<Data> (Create<Packet> (m_virtualPayloadSize));
@@ -172,7 +207,7 @@ CnmrWikiProducer::OnInterest (Ptr<const Interest> interest)
         data->SetKeyLocator (Create<Name> (m_keyLocator));
       }
 
-    NS_LOG_INFO ("Responding with Data: " << data->GetName ());
+    EventLog::Record (EventLog::PRODUCER_DATA, GetNode ()->GetId (), m_face->GetId (), seqName, segment);
 
     // Echo back FwHopCountTag if exists
     FwHopCountTag hopCountTag;
@@ -186,15 +221,13 @@ CnmrWikiProducer::OnInterest (Ptr<const Interest> interest)
   }
   else
     {
-        NS_LOG_INFO("Cannot respond to interest for " << interest->GetName());
+        EventLog::Record (EventLog::PRODUCER_REJECT, GetNode ()->GetId (), m_face->GetId (), seqName, segment);
     }
 
     // (Possible) forward the interest if it has not yet been monitored. The interest is only
     // forwarded to another if if FTBM is enabled. The MonitorAwareRouting takes care of this.
     if(interest->GetMonitored() == 0 && mar != 0)
     {
-        NS_LOG_DEBUG("Served interest but it's not monitored. Forwarding...");
-
         Ptr<Name> nameWithSequence = Create<Name> (interest->GetName ());
 
         Ptr<Interest> newInterest = Create<Interest> ();
@@ -30,6 +30,8 @@
 #include "ns3/ndn-name.h"
 #include "ns3/ndn-data.h"
 
+#include "metrics-registry.h"
+
 #include <vector>
 
 namespace ns3 {
@@ -63,12 +65,16 @@ private:
   Name m_prefix;
   Name m_postfix;
   uint32_t m_virtualPayloadSize;
+  uint32_t m_maxSegments; // when bigger than 1, titles are served as /prefix/title/seg=N
   Time m_freshness;
 
   uint32_t m_signature;
   Name m_keyLocator;
 
   TracedCallback<Ptr<const Interest>, bool, bool> interestConsumedTrace;
+  // Interests for existing/non-existing contents, registered in the MetricsRegistry on start
+  MetricCounter *m_servedInterests;
+  MetricCounter *m_unservedInterests;
   Ptr<ndn::fw::MonitorAwareRouting> mar;
 
   std::vector<Name> m_prefixes;
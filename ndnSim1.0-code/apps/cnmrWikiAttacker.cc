@@ -23,6 +23,8 @@
 #include "ndn-consumer.h"
 #include "cnmrWikiAttacker.h"
 #include "wiki-pagetitle.h"
+#include "hot-path-profiler.h"
+#include "event-log.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -103,7 +105,15 @@ TypeId CnmrWikiAttacker::GetTypeId (void)
 }
 
 CnmrWikiAttacker::CnmrWikiAttacker()
-  : m_firstTime (true){}
+  : m_goodInterests (0)
+  , m_badInterests (0)
+  , m_firstTime (true){}
+
+CnmrWikiAttacker::~CnmrWikiAttacker()
+{
+  for (uint32_t i = 0; i < m_fakeSuffixes.size (); i++)
+    MemoryAccounting::Deallocate (MEM_FAKE_LISTS, MemoryAccounting::StringBytes (m_fakeSuffixes[i]));
+}
 
 void CnmrWikiAttacker::loadFakePrefixesList()
 {
@@ -115,6 +125,7 @@ void CnmrWikiAttacker::loadFakePrefixesList()
   while(getline(titles_file,current_title))
   {
     m_fakeSuffixes.push_back(current_title);
+    MemoryAccounting::Allocate (MEM_FAKE_LISTS, MemoryAccounting::StringBytes (m_fakeSuffixes.back ()));
     titles_counter++; 
   }
   titles_file.close();
@@ -147,6 +158,12 @@ void CnmrWikiAttacker::StartApplication()
 
     m_face->SetFlags(FLAG); // this is used by the MR nodes to detect specific faces
 
+    MetricLabels labels = MetricsRegistry::NodeLabels (GetNode ()->GetId ());
+    labels.push_back (std::make_pair (std::string ("type"), std::string ("legitimate")));
+    m_goodInterests = MetricsRegistry::Get ().AddCounter ("attacker.interests", labels);
+    labels.back ().second = "fake";
+    m_badInterests = MetricsRegistry::Get ().AddCounter ("attacker.interests", labels);
+
     m_randNonce = UniformVariable (0, std::numeric_limits<uint32_t>::max ());
     m_randomSeqId = UniformVariable (1, std::numeric_limits<uint32_t>::max ());
     m_randomTime = UniformVariable (0.0, 2 * 1.0 / m_frequency);
@@ -173,12 +190,8 @@ void CnmrWikiAttacker::StopApplication ()
 
 void CnmrWikiAttacker::ResetCounters()
 {
-  if (!m_firstTime){
-    NS_LOG_INFO("Good Interests "<< goodIs << " Bad Interests "<< badIs);
-    goodIs = 0;
-    badIs = 0 ;
-  }
-  else
+  // the number of good/bad Interests emitted is reported by the MetricsRegistry
+  if (m_firstTime)
     NS_LOG_INFO("This attacker will generate "<< m_goodIs << " Interests for existent contents per second");
   
   m_goodIs = (uint32_t) round(m_purity * m_frequency) ;
@@ -201,6 +214,8 @@ void CnmrWikiAttacker::ScheduleNextPacket()
 
 void CnmrWikiAttacker::SendPacket ()
 {
+    NDN_PROFILE_SCOPE ("CnmrWikiAttacker", "SendPacket");
+
     NS_LOG_FUNCTION (this);
 
     uint32_t seq = GetNextSeq();
@@ -209,11 +224,11 @@ void CnmrWikiAttacker::SendPacket ()
     if (m_purity != 1.0 && m_goodIs > 0){
       suffix = CnmrWikiAttacker::readTrueElement(seq);
       m_goodIs--;
-      goodIs++;
+      m_goodInterests->Inc ();
     }
     else{
       suffix = CnmrWikiAttacker::readFakeElement(seq);
-      badIs++;
+      m_badInterests->Inc ();
     }
 
     Ptr<Name> nameWithSequence = Create<Name> (m_prefixName);
@@ -224,7 +239,7 @@ void CnmrWikiAttacker::SendPacket ()
     interest->SetName                (nameWithSequence);
     interest->SetInterestLifetime    (m_interestLifeTime);
 
-    NS_LOG_INFO ("Requesting Interest: " << *interest);
+    EventLog::Record (EventLog::ATTACKER_INTEREST, GetNode ()->GetId (), m_face->GetId (), suffix, seq);
 
     FwHopCountTag hopCountTag;
     hopCountTag.Add(GetNode()->GetId());
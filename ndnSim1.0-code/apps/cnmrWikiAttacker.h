@@ -34,6 +34,8 @@
 #include <vector>
 #include <stdint.h>
 #include "wiki-client.h"
+#include "metrics-registry.h"
+#include "memory-accounting.h"
 
 namespace ns3 {
 namespace ndn {
@@ -46,14 +48,15 @@ public:
     static TypeId GetTypeId();
 
     CnmrWikiAttacker();
+    virtual ~CnmrWikiAttacker();
 
 protected:
     double              m_frequency; // Frequency of interest packets
     double		m_purity; // Percentage of existing contents requested per sec - 1.0 means all fake Interests
     uint32_t		m_goodIs; // number of existent contents to be requested per second
-    // let me add two convenience counters to check the right num of bad/good interests are emitted each second
-    uint32_t goodIs;
-    uint32_t badIs;
+    // good/bad interests emitted, registered in the MetricsRegistry when the application starts
+    MetricCounter *m_goodInterests;
+    MetricCounter *m_badInterests;
 
     // Random number generator for content IDs
     UniformVariable     m_randomSeqId;
@@ -71,7 +74,7 @@ protected:
 
     std::string m_fakeList;
     uint32_t m_sizeFakeList;
-    std::vector<std::string> m_fakeSuffixes;
+    std::vector<std::string, AccountingAllocator<std::string, MEM_FAKE_LISTS> > m_fakeSuffixes; // string buffers accounted by loadFakePrefixesList
 
     EventId m_sendEvent;
     Name m_prefixName;
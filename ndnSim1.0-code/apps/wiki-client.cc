@@ -18,6 +18,7 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "wiki-client.h"
 #include "wiki-pagetitle.h"
+#include "event-log.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -36,7 +37,10 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include "ns3/ndnSIM/utils/ndn-rtt-mean-deviation.h"
 
 #include <boost/ref.hpp>
+#include <boost/lexical_cast.hpp>
 #include <stdio.h>
+#include <algorithm>
+#include <cmath>
 
 #include "ns3/names.h"
 
@@ -63,6 +67,26 @@ WikiClient::GetTypeId (void)
                    StringValue ("none"),
                    MakeStringAccessor (&WikiClient::SetRandomize, &WikiClient::GetRandomize),
                    MakeStringChecker ())
+    .AddAttribute ("RequestMode", "Interests are either sent at constant rate, cbr (default), or according to a congestion window, window",
+                   StringValue ("cbr"),
+                   MakeStringAccessor (&WikiClient::SetRequestMode, &WikiClient::GetRequestMode),
+                   MakeStringChecker ())
+    .AddAttribute ("InitialWindow", "Initial congestion window, only used in window mode",
+                   StringValue ("1.0"),
+                   MakeDoubleAccessor (&WikiClient::m_initialWindow),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("SlowStartThreshold", "Initial slow start threshold, only used in window mode",
+                   StringValue ("64.0"),
+                   MakeDoubleAccessor (&WikiClient::m_initialSsthresh),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("MaxWindow", "Upper bound of the congestion window, only used in window mode",
+                   StringValue ("1024.0"),
+                   MakeDoubleAccessor (&WikiClient::m_maxWindow),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("DecreaseFactor", "Multiplicative decrease of the congestion window on timeouts and NACKs",
+                   StringValue ("0.5"),
+                   MakeDoubleAccessor (&WikiClient::m_decreaseFactor),
+                   MakeDoubleChecker<double> (0.0, 1.0))
     .AddAttribute ("StartSeq", "Initial sequence number",
                    IntegerValue (0),
                    MakeIntegerAccessor(&WikiClient::m_seq),
@@ -77,6 +101,19 @@ WikiClient::GetTypeId (void)
                    MakeTimeAccessor (&WikiClient::m_interestLifeTime),
                    MakeTimeChecker ())
 
+    .AddAttribute ("AdaptiveLifeTime", "When on, the Interest lifetime is computed as SRTT + k*RTTVAR and clamped between MinLifeTime and LifeTime",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&WikiClient::m_adaptiveLifeTime),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LifeTimeK", "Weight k of the RTT variation in the adaptive Interest lifetime",
+                   StringValue ("4.0"),
+                   MakeDoubleAccessor (&WikiClient::m_lifeTimeK),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinLifeTime", "Lower bound for the adaptive Interest lifetime",
+                   StringValue ("50ms"),
+                   MakeTimeAccessor (&WikiClient::m_minLifeTime),
+                   MakeTimeChecker ())
+
     .AddAttribute ("RetxTimer",
                    "Timeout defining how frequent retransmission timeouts should be checked",
                    StringValue ("50ms"),
@@ -88,6 +125,12 @@ WikiClient::GetTypeId (void)
 
     .AddTraceSource ("FirstInterestDataDelay", "Delay between first transmitted Interest and received Data",
                      MakeTraceSourceAccessor (&WikiClient::m_firstInterestDataDelay))
+
+    .AddTraceSource ("CongestionWindow", "Congestion window used in window mode",
+                     MakeTraceSourceAccessor (&WikiClient::m_cwnd))
+
+    .AddTraceSource ("PitFootprint", "Cumulative time (seconds) of PIT state pinned by the Interests of this consumer",
+                     MakeTraceSourceAccessor (&WikiClient::m_pitFootprint))
     ;
 
   return tid;
@@ -99,6 +142,20 @@ WikiClient::WikiClient ()
   , m_frequency (1.0)
   , m_firstTime (true)
   , m_seq (0)
+  , m_windowMode (false)
+  , m_requestMode ("cbr")
+  , m_cwnd (1.0)
+  , m_initialWindow (1.0)
+  , m_initialSsthresh (64.0)
+  , m_ssthresh (64.0)
+  , m_maxWindow (1024.0)
+  , m_decreaseFactor (0.5)
+  , m_adaptiveLifeTime (false)
+  , m_lifeTimeK (4.0)
+  , m_rttSamples (0)
+  , m_pitFootprint (0.0)
+  , m_firstDelayLatency (0)
+  , m_lastDelayLatency (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_seqMax = (WikiPageTitles::Instance()->size()-1);
@@ -161,9 +218,26 @@ WikiClient::StartApplication () // Called at time specified by Start
   // do base stuff
   App::StartApplication ();
 
+  m_cwnd = m_initialWindow;
+  m_ssthresh = m_initialSsthresh;
+
+  RegisterLatencies ();
+
   ScheduleNextPacket ();
 }
 
+void
+WikiClient::RegisterLatencies ()
+{
+  // labelled with the application id too, a node may host several consumers
+  MetricLabels labels = MetricsRegistry::NodeLabels (GetNode ()->GetId ());
+  labels.push_back (std::make_pair (std::string ("app"), boost::lexical_cast<std::string> (GetId ())));
+  labels.push_back (std::make_pair (std::string ("delay"), std::string ("first")));
+  m_firstDelayLatency = MetricsRegistry::Get ().AddLatency ("consumer.delay", labels);
+  labels.back ().second = "last";
+  m_lastDelayLatency = MetricsRegistry::Get ().AddLatency ("consumer.delay", labels);
+}
+
 void
 WikiClient::StopApplication () // Called at time specified by Stop
 {
@@ -181,8 +255,6 @@ WikiClient::SendPacket ()
 {
   if (!m_active) return;
 
-  NS_LOG_FUNCTION_NOARGS ();
-
   uint32_t seq = 0; //invalid
 
   while (m_retxSeqs.size ())
@@ -210,9 +282,9 @@ WikiClient::SendPacket ()
   Ptr<Interest> interest = Create<Interest> ();
   interest->SetNonce               (m_rand.GetValue ());
   interest->SetName                (nameWithSequence);
-  interest->SetInterestLifetime    (m_interestLifeTime);
+  interest->SetInterestLifetime    (GetNextInterestLifetime ());
 
-  NS_LOG_INFO ("> Interest for " << seqName);
+  EventLog::Record (EventLog::CONSUMER_INTEREST, GetNode ()->GetId (), m_face->GetId (), seqName, seq);
 
   WillSendOutInterest (seq);  
 
@@ -237,11 +309,9 @@ WikiClient::OnData (Ptr<const Data> data)
 
   App::OnData (data); // tracing inside
 
-  NS_LOG_FUNCTION (this << data);
-
   std::string seqName = data->GetName ().get (-1).toBlob ();
   uint32_t seq = WikiPageTitles::Instance()->find(seqName);
-  NS_LOG_INFO ("< DATA for " << seqName);
+  EventLog::Record (EventLog::CONSUMER_DATA, GetNode ()->GetId (), m_face->GetId (), seqName, seq);
 
   int hopCount = -1;
   FwHopCountTag hopCountTag;
@@ -254,22 +324,32 @@ WikiClient::OnData (Ptr<const Data> data)
   if (entry != m_seqLastDelay.end ())
     {
       m_lastRetransmittedInterestDataDelay (this, seq, Simulator::Now () - entry->time, hopCount);
+      m_lastDelayLatency->Record ((Simulator::Now () - entry->time).GetMicroSeconds ());
+      InterestSatisfied (seq, Simulator::Now () - entry->time, m_seqRetxCounts[seq] > 1);
     }
 
   entry = m_seqFullDelay.find (seq);
   if (entry != m_seqFullDelay.end ())
     {
       m_firstInterestDataDelay (this, seq, Simulator::Now () - entry->time, m_seqRetxCounts[seq], hopCount);
+      m_firstDelayLatency->Record ((Simulator::Now () - entry->time).GetMicroSeconds ());
     }
 
   m_seqRetxCounts.erase (seq);
   m_seqFullDelay.erase (seq);
   m_seqLastDelay.erase (seq);
+  m_seqLifeTimes.erase (seq);
 
-  m_seqTimeouts.erase (seq);
+  bool pending = (m_seqTimeouts.erase (seq) > 0);
   m_retxSeqs.erase (seq);
 
   m_rtt->AckSeq (SequenceNumber32 (seq));
+
+  if (m_windowMode && pending)
+    {
+      WindowIncrease ();
+      ScheduleNextPacket ();
+    }
 }
 
 void
@@ -282,19 +362,36 @@ WikiClient::OnNack (Ptr<const Interest> interest)
   std::string seqName = interest->GetName ().get (-1).toBlob ();
   uint32_t seq = WikiPageTitles::Instance()->find(seqName);
 
-  NS_LOG_INFO ("< NACK for " << seqName);
+  EventLog::Record (EventLog::CONSUMER_NACK, GetNode ()->GetId (), m_face->GetId (), seqName, seq);
 
   m_retxSeqs.insert (seq);
 
   m_seqTimeouts.erase (seq);
 
+  // the NACK released the PIT entries on its way back
+  SeqTimeoutsContainer::iterator entry = m_seqLastDelay.find (seq);
+  if (entry != m_seqLastDelay.end ())
+    ReleaseLifeTime (seq, Simulator::Now () - entry->time);
+
   m_rtt->IncreaseMultiplier ();             // Double the next RTO ??
+  if (m_windowMode)
+    WindowDecrease ();
   ScheduleNextPacket ();
 }
 
 void
 WikiClient::ScheduleNextPacket ()
 {
+  if (m_windowMode)
+    {
+      // send as soon as the number of pending Interests is below the window
+      if (!m_sendEvent.IsRunning () &&
+          (m_seqTimeouts.size () < m_cwnd.Get () || m_firstTime))
+        m_sendEvent = Simulator::ScheduleNow (&WikiClient::SendPacket, this);
+      m_firstTime = false;
+      return;
+    }
+
   if (m_firstTime)
     {
       m_sendEvent = Simulator::Schedule (Seconds (0.0),
@@ -315,15 +412,16 @@ WikiClient::OnTimeout (uint32_t sequenceNumber)
 {
   m_rtt->IncreaseMultiplier ();             // Double the next RTO
   m_rtt->SentSeq (SequenceNumber32 (sequenceNumber), 1); // make sure to disable RTT calculation for this sample
+  m_seqLifeTimes.erase (sequenceNumber); // the whole lifetime was pinned
   m_retxSeqs.insert (sequenceNumber);
+  if (m_windowMode)
+    WindowDecrease ();
   ScheduleNextPacket ();
 }
 
 void
 WikiClient::WillSendOutInterest (uint32_t sequenceNumber)
 {
-  NS_LOG_DEBUG ("Trying to add " << sequenceNumber << " with " << Simulator::Now () << ". already " << m_seqTimeouts.size () << " items");
-
   m_seqTimeouts.insert (SeqTimeout (sequenceNumber, Simulator::Now ()));
   m_seqFullDelay.insert (SeqTimeout (sequenceNumber, Simulator::Now ()));
 
@@ -332,6 +430,12 @@ WikiClient::WillSendOutInterest (uint32_t sequenceNumber)
 
   m_seqRetxCounts[sequenceNumber] ++;
 
+  // until the Interest is satisfied, we assume it pins the PIT state for its whole lifetime
+  if (m_currentLifeTime.IsZero ())
+    m_currentLifeTime = m_interestLifeTime;
+  m_seqLifeTimes[sequenceNumber] = m_currentLifeTime;
+  m_pitFootprint = m_pitFootprint.Get () + m_currentLifeTime.ToDouble (Time::S);
+
   m_rtt->SentSeq (SequenceNumber32 (sequenceNumber), 1);
 }
 
@@ -361,5 +465,91 @@ WikiClient::GetRandomize () const
   return m_randomType;
 }
 
+void
+WikiClient::SetRequestMode (const std::string &value)
+{
+  NS_ASSERT_MSG (value == "cbr" || value == "window", "Unknown request mode " << value);
+
+  m_windowMode = (value == "window");
+  m_requestMode = value;
+}
+
+std::string
+WikiClient::GetRequestMode () const
+{
+  return m_requestMode;
+}
+
+void
+WikiClient::WindowIncrease ()
+{
+  double cwnd = m_cwnd.Get ();
+  if (cwnd < m_ssthresh)
+    cwnd += 1.0;          // slow start
+  else
+    cwnd += 1.0 / cwnd;   // additive increase, one Interest per window
+
+  m_cwnd = std::min (cwnd, m_maxWindow);
+}
+
+void
+WikiClient::WindowDecrease ()
+{
+  // all the losses within the same RTT come from the same congestion event
+  Time now = Simulator::Now ();
+  if (m_lastWindowCut != Time () && (now - m_lastWindowCut) < m_rtt->GetCurrentEstimate ())
+    return;
+
+  m_lastWindowCut = now;
+  m_ssthresh = std::max (m_cwnd.Get () * m_decreaseFactor, 1.0);
+  m_cwnd = m_ssthresh;
+}
+
+Time
+WikiClient::GetNextInterestLifetime ()
+{
+  m_currentLifeTime = m_interestLifeTime;
+
+  // no RTT sample yet, stick to the static value
+  if (m_adaptiveLifeTime && m_rttSamples > 0)
+    {
+      Time lifetime = m_rtt->GetCurrentEstimate () + Seconds (m_lifeTimeK * m_rttVar.ToDouble (Time::S));
+      m_currentLifeTime = std::max (m_minLifeTime, std::min (lifetime, m_interestLifeTime));
+    }
+
+  return m_currentLifeTime;
+}
+
+void
+WikiClient::ReleaseLifeTime (uint32_t sequenceNumber, Time held)
+{
+  SeqLifeTimesContainer::iterator it = m_seqLifeTimes.find (sequenceNumber);
+  if (it == m_seqLifeTimes.end ())
+    return;
+
+  if (held < it->second)
+    m_pitFootprint = m_pitFootprint.Get () - (it->second - held).ToDouble (Time::S);
+  m_seqLifeTimes.erase (it);
+}
+
+void
+WikiClient::InterestSatisfied (uint32_t sequenceNumber, Time delay, bool retransmitted)
+{
+  // the PIT entry was released as soon as the Data came back
+  ReleaseLifeTime (sequenceNumber, delay);
+
+  if (retransmitted)
+    return; // Karn's rule, ambiguous sample
+
+  // same gain as the classic RTTVAR estimator, RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - sample|
+  double sample = delay.ToDouble (Time::S);
+  double deviation = std::fabs (m_rtt->GetCurrentEstimate ().ToDouble (Time::S) - sample);
+
+  if (m_rttSamples++ == 0)
+    m_rttVar = Seconds (sample / 2);
+  else
+    m_rttVar = Seconds (0.75 * m_rttVar.ToDouble (Time::S) + 0.25 * deviation);
+}
+
 } // namespace ndn
 } // namespace ns3
@@ -27,6 +27,10 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/ndn-rtt-estimator.h"
+#include "ns3/traced-value.h"
+
+#include "metrics-registry.h"
+#include "memory-accounting.h"
 
 #include <set>
 #include <map>
@@ -119,6 +123,63 @@ protected:
    */
   std::string
   GetRandomize () const;
+
+  /**
+   * @brief Set the request mode
+   * @param value Either 'cbr' (default) or 'window'
+   */
+  void
+  SetRequestMode (const std::string &value);
+
+  /**
+   * @brief Get the request mode
+   * @returns either 'cbr' or 'window'
+   */
+  std::string
+  GetRequestMode () const;
+
+  /**
+   * \brief Window mode: grows the congestion window on Data reception (slow start, then additive increase)
+   */
+  void
+  WindowIncrease ();
+
+  /**
+   * \brief Window mode: cuts the congestion window on timeouts and NACKs, at most once per estimated RTT
+   */
+  void
+  WindowDecrease ();
+
+  /**
+   * \brief Returns the lifetime for the next Interest, that is, either the LifeTime attribute
+   * or, in adaptive mode, SRTT + k*RTTVAR clamped between MinLifeTime and LifeTime
+   */
+  Time
+  GetNextInterestLifetime ();
+
+  /**
+   * \brief Updates the RTT variation and the PIT footprint when a pending Interest gets satisfied
+   * \param delay Delay between the last transmission of the Interest and the Data
+   * \param retransmitted True if the Interest was sent more than once (no RTT sample then)
+   */
+  void
+  InterestSatisfied (uint32_t sequenceNumber, Time delay, bool retransmitted);
+
+  /**
+   * \brief Forgets the lifetime of a pending Interest whose PIT state was released,
+   * giving back to the PIT footprint the part of the lifetime it did not pin
+   * \param held Time elapsed since the last transmission of the Interest
+   */
+  void
+  ReleaseLifeTime (uint32_t sequenceNumber, Time held);
+
+  /**
+   * \brief Registers the first and last delay latency histograms in the MetricsRegistry,
+   * to be called by the StartApplication of every consumer
+   */
+  void
+  RegisterLatencies ();
+
   /**
    * \brief Checks if the packet need to be retransmitted becuase of retransmission timer expiration
    */
@@ -159,11 +220,34 @@ protected:
   Name     m_interestName;        ///< \brief NDN Name of the Interest (use Name)
   Time               m_interestLifeTime;    ///< \brief LifeTime for interest packet
 
+  // Window-based request mode, when off Interests are sent at a constant rate
+  bool                m_windowMode;
+  std::string         m_requestMode;
+  TracedValue<double> m_cwnd;          ///< \brief congestion window, i.e., max num of pending Interests
+  double              m_initialWindow;
+  double              m_initialSsthresh;
+  double              m_ssthresh;      ///< \brief slow start threshold, moved by the window cuts
+  double              m_maxWindow;
+  double              m_decreaseFactor; ///< \brief multiplicative decrease factor
+  Time                m_lastWindowCut;
+
+  // RTT-adaptive Interest lifetime
+  bool                m_adaptiveLifeTime;
+  double              m_lifeTimeK;        ///< \brief weight of the RTT variation
+  Time                m_minLifeTime;
+  Time                m_currentLifeTime;  ///< \brief lifetime of the Interest being sent out
+  Time                m_rttVar;           ///< \brief RTT variation, the RTT estimator does not expose its own
+  uint32_t            m_rttSamples;
+  typedef std::map<uint32_t, Time, std::less<uint32_t>,
+                   AccountingAllocator<std::pair<const uint32_t, Time>, MEM_CLIENT_INFLIGHT> > SeqLifeTimesContainer;
+  SeqLifeTimesContainer m_seqLifeTimes;
+  TracedValue<double> m_pitFootprint;     ///< \brief seconds of PIT state pinned in the network by this consumer
+
      
 				    /*  * \struct This struct contains sequence numbers of packets to be retransmitted
    */
   struct RetxSeqsContainer :
-    public std::set<uint32_t> { };
+    public std::set<uint32_t, std::less<uint32_t>, AccountingAllocator<uint32_t, MEM_CLIENT_INFLIGHT> > { };
 
   RetxSeqsContainer m_retxSeqs;             ///< \brief ordered set of sequence numbers to be retransmitted
 
@@ -200,14 +284,16 @@ protected:
         boost::multi_index::tag<i_timestamp>,
         boost::multi_index::member<SeqTimeout, Time, &SeqTimeout::time>
         >
-      >
+      >,
+    AccountingAllocator<SeqTimeout, MEM_CLIENT_INFLIGHT>
     > { } ;
 
   SeqTimeoutsContainer m_seqTimeouts;       ///< \brief multi-index for the set of SeqTimeout structs
 
   SeqTimeoutsContainer m_seqLastDelay;
   SeqTimeoutsContainer m_seqFullDelay;
-  std::map<uint32_t, uint32_t> m_seqRetxCounts;
+  std::map<uint32_t, uint32_t, std::less<uint32_t>,
+           AccountingAllocator<std::pair<const uint32_t, uint32_t>, MEM_CLIENT_INFLIGHT> > m_seqRetxCounts;
 
   TracedCallback<Ptr<App> /* app */, uint32_t /* seqno */,
                  Time /* delay */, int32_t /*hop count*/> m_lastRetransmittedInterestDataDelay;
@@ -215,6 +301,11 @@ protected:
                  Time /* delay */, uint32_t /*retx count*/,
                  int32_t /*hop count*/> m_firstInterestDataDelay;
 
+  // same delays as the two trace sources above, kept in the MetricsRegistry as latency
+  // histograms and summarized once per period (registered when the application starts)
+  LatencyHistogram *m_firstDelayLatency;
+  LatencyHistogram *m_lastDelayLatency;
+
 private:
 
 /// @endcond
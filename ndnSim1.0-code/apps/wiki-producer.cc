@@ -18,6 +18,8 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "wiki-pagetitle.h"
 #include "wiki-producer.h"
+#include "hot-path-profiler.h"
+#include "event-log.h"
 #include "ns3/log.h"
 #include "ns3/ndn-interest.h"
 #include "ns3/ndn-data.h"
@@ -62,6 +64,10 @@ WikiProducer::GetTypeId (void)
                    UintegerValue (1024),
                    MakeUintegerAccessor (&WikiProducer::m_virtualPayloadSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSegments", "Max number of segments per title, if 1 (default), then titles are not segmented",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&WikiProducer::m_maxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("Freshness", "Freshness of data packets, if 0, then unlimited freshness",
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&WikiProducer::m_freshness),
@@ -79,6 +85,7 @@ WikiProducer::GetTypeId (void)
 }
 
 WikiProducer::WikiProducer ()
+  : m_maxSegments (1)
 {
   // NS_LOG_FUNCTION_NOARGS ();
 }
@@ -115,16 +122,31 @@ WikiProducer::StopApplication ()
 void
 WikiProducer::OnInterest (Ptr<const Interest> interest)
 {
-  App::OnInterest (interest); // tracing inside
+  NDN_PROFILE_SCOPE ("WikiProducer", "OnInterest");
 
-  NS_LOG_FUNCTION (this << interest);
+  App::OnInterest (interest); // tracing inside
 
   if (!m_active) return;
 
   // check if Interest is legitimate or malicious
   std::string seqName = interest->GetName ().get (-1).toBlob ();
-  NS_LOG_INFO("Received Interest for "<< seqName);
-  if(WikiPageTitles::Instance()->find(seqName) == -1)
+  uint32_t segment = 0;
+  bool segmented = m_maxSegments > 1 && interest->GetName ().size () > 1 &&
+    WikiPageTitles::parseSegment (seqName, segment);
+  if (segmented)
+    {
+      // segmented object, the title is the second to last component
+      seqName = interest->GetName ().get (-2).toBlob ();
+    }
+  EventLog::Record (EventLog::PRODUCER_INTEREST, GetNode ()->GetId (), m_face->GetId (), seqName, segment);
+
+  if (segmented)
+    {
+      int32_t index = WikiPageTitles::Instance()->find(seqName);
+      if (index == -1 || segment >= WikiPageTitles::Instance()->segments(index, m_maxSegments))
+        return;
+    }
+  else if(WikiPageTitles::Instance()->find(seqName) == -1)
     return;
 
   Ptr<Data> data = Create<Data> (Create<Packet> (m_virtualPayloadSize));
@@ -140,7 +162,7 @@ WikiProducer::OnInterest (Ptr<const Interest> interest)
       data->SetKeyLocator (Create<Name> (m_keyLocator));
     }
 
-  NS_LOG_INFO ("node("<< GetNode()->GetId() <<") responding with Data: " << data->GetName ());
+  EventLog::Record (EventLog::PRODUCER_DATA, GetNode ()->GetId (), m_face->GetId (), seqName, segment);
 
   FwHopCountTag hopCountTag;
   if (interest->GetPayload ()->PeekPacketTag (hopCountTag))
@@ -58,6 +58,7 @@ private:
   Name m_prefix;
   Name m_postfix;
   uint32_t m_virtualPayloadSize;
+  uint32_t m_maxSegments; // when bigger than 1, titles are served as /prefix/title/seg=N
   Time m_freshness;
 
   uint32_t m_signature;
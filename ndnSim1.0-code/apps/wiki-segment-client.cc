@@ -0,0 +1,324 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "wiki-segment-client.h"
+#include "wiki-pagetitle.h"
+#include "event-log.h"
+#include "ns3/ptr.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/callback.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include "ns3/ndn-app-face.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-data.h"
+#include "ns3/ndnSIM/utils/ndn-fw-hop-count-tag.h"
+#include "ns3/ndnSIM/utils/interest-type-tag.h"
+
+NS_LOG_COMPONENT_DEFINE ("ndn.WikiSegmentClient");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED (WikiSegmentClient);
+
+TypeId
+WikiSegmentClient::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ndn::WikiSegmentClient")
+    .SetGroupName ("Ndn")
+    .SetParent<WikiClient> ()
+    .AddConstructor<WikiSegmentClient> ()
+    .AddAttribute ("PipelineWindow", "Max number of segments pending at the same time",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&WikiSegmentClient::m_window),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxSegments", "Max number of segments per title, it must be the same used by the producers",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&WikiSegmentClient::m_maxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+
+    .AddTraceSource ("ObjectRetrieved", "Time elapsed between the first Interest and the last Data of a title",
+                     MakeTraceSourceAccessor (&WikiSegmentClient::m_objectRetrieved))
+    ;
+
+  return tid;
+}
+
+WikiSegmentClient::WikiSegmentClient ()
+  : m_window (4)
+  , m_maxSegments (8)
+  , m_inObject (false)
+  , m_title (0)
+  , m_segCount (0)
+  , m_nextSeg (0)
+  , m_segDone (0)
+  , m_objectBase (0)
+  , m_objectRetx (0)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+WikiSegmentClient::StartApplication ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  App::StartApplication ();
+  RegisterLatencies ();
+
+  ScheduleNextObject ();
+}
+
+void
+WikiSegmentClient::StopApplication ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  WikiClient::StopApplication ();
+}
+
+void
+WikiSegmentClient::ScheduleNextObject ()
+{
+  if (m_firstTime)
+    {
+      m_sendEvent = Simulator::Schedule (Seconds (0.0),
+                                         &WikiSegmentClient::StartObject, this);
+      m_firstTime = false;
+    }
+  else if (!m_sendEvent.IsRunning ())
+    m_sendEvent = Simulator::Schedule (
+                                       (m_random == 0) ?
+                                         Seconds(1.0 / m_frequency)
+                                       :
+                                         Seconds(m_random->GetValue ()),
+                                       &WikiSegmentClient::StartObject, this);
+}
+
+void
+WikiSegmentClient::StartObject ()
+{
+  if (!m_active) return;
+
+  if (m_seq >= m_seqMax)
+    {
+      return; // we are totally done
+    }
+
+  m_title = m_seq++;
+  m_titleName = WikiPageTitles::Instance()->readElement(m_title);
+  m_segCount = WikiPageTitles::Instance()->segments(m_title, m_maxSegments);
+
+  m_objectBase += m_nextSeg; // skip the segments of the previous title
+  m_nextSeg = 0;
+  m_segDone = 0;
+  m_objectRetx = 0;
+  m_objectStart = Simulator::Now ();
+  m_inObject = true;
+
+  // stale retransmissions of the previous title must not be sent out
+  m_retxSeqs.clear ();
+
+  NS_LOG_INFO ("> Object " << m_titleName << " with " << m_segCount << " segments");
+
+  FillWindow ();
+}
+
+void
+WikiSegmentClient::FillWindow ()
+{
+  while (m_active && m_inObject && m_seqTimeouts.size () < m_window)
+    {
+      uint32_t seq;
+      if (!m_retxSeqs.empty ())
+        {
+          seq = *m_retxSeqs.begin ();
+          m_retxSeqs.erase (m_retxSeqs.begin ());
+          m_objectRetx++;
+        }
+      else if (m_nextSeg < m_segCount)
+        seq = m_objectBase + m_nextSeg++;
+      else
+        break; // all the segments have been requested, just wait
+
+      SendSegment (seq);
+    }
+}
+
+void
+WikiSegmentClient::SendSegment (uint32_t seq)
+{
+  NS_LOG_FUNCTION (seq);
+
+  Ptr<Name> nameWithSequence = Create<Name> (m_interestName);
+  nameWithSequence->append (m_titleName);
+  nameWithSequence->append (WikiPageTitles::segmentComponent (seq - m_objectBase));
+
+  Ptr<Interest> interest = Create<Interest> ();
+  interest->SetNonce               (m_rand.GetValue ());
+  interest->SetName                (nameWithSequence);
+  interest->SetInterestLifetime    (GetNextInterestLifetime ());
+
+  EventLog::Record (EventLog::CONSUMER_INTEREST, GetNode ()->GetId (), m_face->GetId (), m_titleName, seq - m_objectBase);
+
+  WillSendOutInterest (seq);
+
+  FwHopCountTag hopCountTag;
+  interest->GetPayload ()->AddPacketTag (hopCountTag);
+
+  InterestTypeTag interestTypeTag;
+  interestTypeTag.Set(1);
+  interest->GetPayload ()->AddPacketTag(interestTypeTag);
+
+  m_transmittedInterests (interest, this, m_face);
+  m_face->ReceiveInterest (interest);
+}
+
+bool
+WikiSegmentClient::GetSegmentSeq (const Name &name, uint32_t &seq) const
+{
+  uint32_t segment;
+  if (!m_inObject || name.size () < 2 ||
+      !WikiPageTitles::parseSegment (name.get (-1).toBlob (), segment))
+    return false;
+
+  if (segment >= m_segCount || name.get (-2).toBlob () != m_titleName)
+    return false;
+
+  seq = m_objectBase + segment;
+  return true;
+}
+
+///////////////////////////////////////////////////
+//          Process incoming packets             //
+///////////////////////////////////////////////////
+
+void
+WikiSegmentClient::OnData (Ptr<const Data> data)
+{
+  if (!m_active) return;
+
+  App::OnData (data); // tracing inside
+
+  uint32_t seq;
+  if (!GetSegmentSeq (data->GetName (), seq))
+    {
+      NS_LOG_DEBUG ("< DATA not belonging to the current object " << data->GetName ());
+      return;
+    }
+
+  EventLog::Record (EventLog::CONSUMER_DATA, GetNode ()->GetId (), m_face->GetId (), m_titleName, seq - m_objectBase);
+
+  int hopCount = -1;
+  FwHopCountTag hopCountTag;
+  if (data->GetPayload ()->PeekPacketTag (hopCountTag))
+    {
+      hopCount = hopCountTag.Get ();
+    }
+
+  SeqTimeoutsContainer::iterator entry = m_seqLastDelay.find (seq);
+  if (entry != m_seqLastDelay.end ())
+    {
+      m_lastRetransmittedInterestDataDelay (this, seq, Simulator::Now () - entry->time, hopCount);
+      m_lastDelayLatency->Record ((Simulator::Now () - entry->time).GetMicroSeconds ());
+      InterestSatisfied (seq, Simulator::Now () - entry->time, m_seqRetxCounts[seq] > 1);
+    }
+
+  // the first Data for a segment is the only one counting towards the object completion
+  bool firstData = false;
+  entry = m_seqFullDelay.find (seq);
+  if (entry != m_seqFullDelay.end ())
+    {
+      m_firstInterestDataDelay (this, seq, Simulator::Now () - entry->time, m_seqRetxCounts[seq], hopCount);
+      m_firstDelayLatency->Record ((Simulator::Now () - entry->time).GetMicroSeconds ());
+      firstData = true;
+    }
+
+  m_seqRetxCounts.erase (seq);
+  m_seqFullDelay.erase (seq);
+  m_seqLastDelay.erase (seq);
+  m_seqLifeTimes.erase (seq);
+
+  m_seqTimeouts.erase (seq);
+  m_retxSeqs.erase (seq);
+
+  m_rtt->AckSeq (SequenceNumber32 (seq));
+
+  if (firstData && ++m_segDone == m_segCount)
+    {
+      Time completion = Simulator::Now () - m_objectStart;
+      NS_LOG_INFO ("< Object " << m_titleName << " retrieved in " << completion.ToDouble (Time::S) << "s");
+
+      m_objectRetrieved (this, m_title, m_segCount, completion, m_objectRetx);
+      m_inObject = false;
+
+      ScheduleNextObject ();
+      return;
+    }
+
+  FillWindow ();
+}
+
+void
+WikiSegmentClient::OnNack (Ptr<const Interest> interest)
+{
+  if (!m_active) return;
+
+  App::OnNack (interest); // tracing inside
+
+  uint32_t seq;
+  if (!GetSegmentSeq (interest->GetName (), seq))
+    return;
+
+  EventLog::Record (EventLog::CONSUMER_NACK, GetNode ()->GetId (), m_face->GetId (), m_titleName, seq - m_objectBase);
+
+  m_retxSeqs.insert (seq);
+  m_seqTimeouts.erase (seq);
+
+  // the NACK released the PIT entries on its way back
+  SeqTimeoutsContainer::iterator entry = m_seqLastDelay.find (seq);
+  if (entry != m_seqLastDelay.end ())
+    ReleaseLifeTime (seq, Simulator::Now () - entry->time);
+
+  m_rtt->IncreaseMultiplier ();             // Double the next RTO ??
+
+  // NACKs may be returned while the Interest is still being sent out, so the
+  // window is refilled out of this call chain
+  Simulator::ScheduleNow (&WikiSegmentClient::FillWindow, this);
+}
+
+void
+WikiSegmentClient::OnTimeout (uint32_t sequenceNumber)
+{
+  m_rtt->IncreaseMultiplier ();             // Double the next RTO
+  m_rtt->SentSeq (SequenceNumber32 (sequenceNumber), 1); // make sure to disable RTT calculation for this sample
+  m_seqLifeTimes.erase (sequenceNumber); // the whole lifetime was pinned
+
+  if (!m_inObject || sequenceNumber < m_objectBase)
+    return; // stale timeout of a previous object
+
+  m_retxSeqs.insert (sequenceNumber);
+  FillWindow ();
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,114 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NDN_WIKISEGMENTCLIENT_H
+#define NDN_WIKISEGMENTCLIENT_H
+
+#include "wiki-client.h"
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @ingroup ndn-apps
+ * \brief WikiClient fetching whole segmented objects
+ *
+ * Every title is requested as a sequence of segments /prefix/title/seg=N, the number of
+ * segments of a title is given by WikiPageTitles::segments. At most PipelineWindow segments
+ * are pending at any time. Once all the segments of a title are received, the object
+ * completion time is reported through the ObjectRetrieved trace source and the next title
+ * is requested after 1/Frequency (or a random gap, see the Randomize attribute).
+ *
+ * Sequence numbers used for retransmissions and RTT estimation are global segment counters,
+ * the segments of the current object are [m_objectBase, m_objectBase + m_segCount).
+ */
+class WikiSegmentClient: public WikiClient
+{
+public:
+  static TypeId GetTypeId ();
+
+  WikiSegmentClient ();
+  virtual ~WikiSegmentClient () {};
+
+  virtual void
+  OnNack (Ptr<const Interest> interest);
+
+  virtual void
+  OnData (Ptr<const Data> contentObject);
+
+  virtual void
+  OnTimeout (uint32_t sequenceNumber);
+
+protected:
+  // from App
+  virtual void
+  StartApplication ();
+
+  virtual void
+  StopApplication ();
+
+  /**
+   * \brief Schedules the request of the next title
+   */
+  void
+  ScheduleNextObject ();
+
+  /**
+   * \brief Starts the retrieval of the next title
+   */
+  void
+  StartObject ();
+
+  /**
+   * \brief Sends out Interests until the pipeline window is full
+   */
+  void
+  FillWindow ();
+
+  void
+  SendSegment (uint32_t seq);
+
+  /**
+   * \brief Maps a received name on a global segment sequence number
+   * \return false if the name does not belong to the object currently being retrieved
+   */
+  bool
+  GetSegmentSeq (const Name &name, uint32_t &seq) const;
+
+protected:
+  uint32_t m_window;       ///< \brief max number of pending segments
+  uint32_t m_maxSegments;  ///< \brief max number of segments per title, must match the producers' one
+
+  bool        m_inObject;  ///< \brief true while a title is being retrieved
+  uint32_t    m_title;     ///< \brief index of the title currently retrieved
+  std::string m_titleName;
+  uint32_t    m_segCount;  ///< \brief number of segments of the current title
+  uint32_t    m_nextSeg;   ///< \brief next segment never requested so far
+  uint32_t    m_segDone;   ///< \brief number of segments received so far
+  uint32_t    m_objectBase; ///< \brief sequence number of the first segment of the current title
+  uint32_t    m_objectRetx; ///< \brief number of retransmissions for the current title
+  Time        m_objectStart;
+
+  TracedCallback<Ptr<App> /* app */, uint32_t /* title */, uint32_t /* segments */,
+                 Time /* completion time */, uint32_t /* retx count */> m_objectRetrieved;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif
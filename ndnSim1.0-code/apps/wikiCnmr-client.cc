@@ -25,6 +25,7 @@
 
 #include "wiki-client.h"
 #include "wiki-pagetitle.h"
+#include "event-log.h"
 #include "wikiCnmr-client.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
@@ -116,6 +117,7 @@ WikiCnmrClient::StartApplication () // Called at time specified by Start
   // SetNumberOfContents (wikiFileSize);
 
   App::StartApplication ();
+  RegisterLatencies ();
 
   ScheduleNextPacket ();
 }
@@ -164,7 +166,6 @@ WikiCnmrClient::SendPacket ()
   // The index is computed somewhere else where clients can be distinguished, so in the following
   // call we just use it 
   
-  NS_LOG_INFO ("> Index for the bucket is " << (m_index_offset + seq));
   std::string seqName = WikiPageTitles::Instance()->readElement(m_index_offset + seq);
   Ptr<Name> nameWithSequence = Create<Name> (GetNextPrefix());
   nameWithSequence->append (seqName);
@@ -175,7 +176,7 @@ WikiCnmrClient::SendPacket ()
   interest->SetName                (nameWithSequence);
   interest->SetInterestLifetime    (m_interestLifeTime);
 
-  NS_LOG_INFO ("> Interest for " << seqName);
+  EventLog::Record (EventLog::CONSUMER_INTEREST, GetNode ()->GetId (), m_face->GetId (), seqName, seq);
 
   WillSendOutInterest (seq);  
 
@@ -0,0 +1,59 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */ /*
+ * Copyright (c) 2016 University of Luxembourg
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello  <salvatore.signorello@uni.lu>
+ */
+
+// Converts a columnar trace (e.g., InterestTracer with FORMAT_COLUMNAR) back to the text
+// format of the tracer, optionally restricted to a time interval. Example:
+//
+// ./waf --run="columnar-trace-dump --trace=interest-trace.ctr --from=10 --to=20" > interest-trace.txt
+
+#include "ns3/core-module.h"
+#include "ns3/ndnSIM/utils/columnar-trace.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+  std::string trace;
+  double from = -1;
+  double to = -1;
+
+    CommandLine cmd;
+    cmd.AddValue("trace", "Columnar trace to be converted", trace);
+    cmd.AddValue("from", "Print the rows from this time (seconds), -1 from the beginning", from);
+    cmd.AddValue("to", "Print the rows up to this time (seconds), -1 up to the end", to);
+    cmd.Parse(argc, argv);
+
+    ndn::ColumnarTraceReader reader;
+    if (!reader.Open(trace))
+      {
+        std::cerr << "Cannot read " << trace << ", either it is not a columnar trace or it was not closed" << std::endl;
+        return 1;
+      }
+
+    if (!reader.PrintText(std::cout, from, to))
+      {
+        std::cerr << "Corrupted block in " << trace << std::endl;
+        return 1;
+      }
+
+    return 0;
+}
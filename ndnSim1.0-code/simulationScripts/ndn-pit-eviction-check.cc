@@ -0,0 +1,156 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */ /*
+ * Copyright (c) 2016 University of Luxembourg
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello  <salvatore.signorello@uni.lu>
+ * Some code neither licensed nor public was provided by:
+ */
+
+// Check of the PIT occupancy tracked by the PitTelemetry of Poseidon. The router has a
+// small LRU PIT and the producer sits behind a long link, so the PIT is full most of the
+// time and entries are evicted before their Data comes back. PitUsageStep is set to
+// half an entry, so PITUsage reports the tracked occupancy at every change, in between
+// the periodic resynchronizations with the PIT. The tracked occupancy must never be
+// below the PIT size by more than the entry being released (releases are accounted just
+// before the PIT erases the entry), otherwise entries were released twice; it can be
+// above it, for the entries evicted since the last resynchronization, which are counted
+// as overcounts. The script exits with 1 if the check fails or if the PIT never filled
+// up. Example:
+//
+// ./waf --run="ndn-pit-eviction-check --titles=wikiSmallSample.txt"
+
+#include "ns3/wiki-pagetitle.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+static Ptr<ndn::Pit> g_pit;
+static uint32_t g_pitSize = 50;
+static uint32_t g_samples = 0;
+static uint32_t g_fullSamples = 0;
+static uint32_t g_mismatches = 0;
+static uint32_t g_overcounts = 0;
+
+// entries is the number of entries tracked by the strategy, usage is the same over the
+// PIT size
+static void
+CheckPitUsage (double usage, uint32_t entries)
+{
+  g_samples++;
+  uint32_t size = g_pit->GetSize ();
+  if (size >= g_pitSize)
+    g_fullSamples++;
+
+  if (entries + 1 < size || std::fabs (usage * g_pitSize - entries) > 0.5)
+    {
+      g_mismatches++;
+      std::cerr << Simulator::Now ().ToDouble (Time::S) << "s: PITUsage " << usage
+                << " (" << entries << " entries), PIT size " << size << std::endl;
+    }
+  else if (entries > size)
+    g_overcounts++;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string titles = "wikiSmallSample.txt";
+  uint32_t degree = 8;
+  double frequency = 200.0;
+  double stop = 10.0;
+
+  Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("100Mbps"));
+  Config::SetDefault("ns3::PointToPointChannel::Delay", StringValue("5ms"));
+  Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("1000"));
+
+    CommandLine cmd;
+    cmd.AddValue("titles", "File containing the list of page titles", titles);
+    cmd.AddValue("pitSize", "Max number of entries of the PIT of the router", g_pitSize);
+    cmd.AddValue("degree", "Number of consumers attached to the router", degree);
+    cmd.AddValue("frequency", "Interests per second of each consumer", frequency);
+    cmd.AddValue("stop", "Simulation time in seconds", stop);
+    cmd.Parse(argc, argv);
+
+    // PITUsage is reported at every change of the tracked occupancy
+    Config::SetDefault("ns3::ndn::fw::Poseidon::PitUsageStep", DoubleValue(0.5 / g_pitSize));
+
+    WikiPageTitles::Instance()->load(titles);
+
+    // node 0 is the router, node 1 the producer, all the others are consumers
+    NodeContainer nodes;
+    nodes.Create(degree + 2);
+
+    PointToPointHelper p2p;
+    for (uint32_t i = 2; i < nodes.GetN(); i++)
+      p2p.Install(nodes.Get(0), nodes.Get(i));
+
+    p2p.SetChannelAttribute("Delay", StringValue("200ms"));
+    p2p.Install(nodes.Get(0), nodes.Get(1));
+
+    std::ostringstream maxSize;
+    maxSize << g_pitSize;
+
+    ndn::StackHelper ndnHelper;
+    ndnHelper.SetForwardingStrategy("ns3::ndn::fw::Poseidon");
+    ndnHelper.SetPit("ns3::ndn::pit::Lru", "MaxSize", maxSize.str());
+    ndnHelper.InstallAll();
+
+    ndn::GlobalRoutingHelper routingHelper;
+    routingHelper.InstallAll();
+
+    ndn::AppHelper consumerHelper("ns3::ndn::WikiClient");
+    consumerHelper.SetPrefix("/prefix");
+    consumerHelper.SetAttribute("Frequency", DoubleValue(frequency));
+    for (uint32_t i = 2; i < nodes.GetN(); i++)
+      consumerHelper.Install(nodes.Get(i));
+
+    ndn::AppHelper producerHelper("ns3::ndn::WikiProducer");
+    producerHelper.SetPrefix("/prefix");
+    producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+    producerHelper.Install(nodes.Get(1));
+
+    routingHelper.AddOrigins("/prefix", nodes.Get(1));
+    routingHelper.CalculateRoutes();
+
+    g_pit = nodes.Get(0)->GetObject<ndn::Pit>();
+    nodes.Get(0)->GetObject<ndn::ForwardingStrategy>()->TraceConnectWithoutContext("PITUsage", MakeCallback(&CheckPitUsage));
+
+    Simulator::Stop(Seconds(stop));
+    Simulator::Run();
+
+    std::cout << "samples=" << g_samples
+              << " full=" << g_fullSamples
+              << " overcounts=" << g_overcounts
+              << " mismatches=" << g_mismatches
+              << std::endl;
+
+    g_pit = 0;
+    Simulator::Destroy();
+
+    if (g_fullSamples == 0)
+      {
+        std::cerr << "The PIT never filled up, no eviction was exercised" << std::endl;
+        return 1;
+      }
+
+    return g_mismatches == 0 ? 0 : 1;
+}
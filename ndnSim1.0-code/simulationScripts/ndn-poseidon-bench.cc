@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */ /*
+ * Copyright (c) 2016 University of Luxembourg
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello  <salvatore.signorello@uni.lu>
+ * Some code neither licensed nor public was provided by:
+ */
+
+// Benchmark of the per-Interest cost of the Poseidon strategy on a high-degree router.
+// A single router running Poseidon is connected to 'degree' consumers and to one producer,
+// the script reports the wall-clock time spent in the simulation per Interest sent out
+// by the consumers. Example:
+//
+// ./waf --run="ndn-poseidon-bench --titles=wikiSmallSample.txt --degree=256 --frequency=100"
+
+#include "ns3/wiki-pagetitle.h"
+#include "ns3/hot-path-profiler.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+
+static uint64_t g_interests = 0;
+
+static void
+CountInterest (Ptr<const ndn::Interest>, Ptr<ndn::App>, Ptr<ndn::Face>)
+{
+  g_interests++;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string titles = "wikiSmallSample.txt";
+  std::string strategy = "ns3::ndn::fw::Poseidon";
+  uint32_t degree = 128;
+  double frequency = 100.0;
+  double stop = 20.0;
+
+  Config::SetDefault("ns3::PointToPointNetDevice::DataRate", StringValue("100Mbps"));
+  Config::SetDefault("ns3::PointToPointChannel::Delay", StringValue("5ms"));
+  Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("100"));
+
+    CommandLine cmd;
+    cmd.AddValue("titles", "File containing the list of page titles", titles);
+    cmd.AddValue("strategy", "Forwarding strategy installed on the router", strategy);
+    cmd.AddValue("degree", "Number of consumers attached to the router", degree);
+    cmd.AddValue("frequency", "Interests per second of each consumer", frequency);
+    cmd.AddValue("stop", "Simulation time in seconds", stop);
+    cmd.Parse(argc, argv);
+
+    WikiPageTitles::Instance()->load(titles);
+
+    // node 0 is the router, node 1 the producer, all the others are consumers
+    NodeContainer nodes;
+    nodes.Create(degree + 2);
+
+    PointToPointHelper p2p;
+    for (uint32_t i = 1; i < nodes.GetN(); i++)
+      p2p.Install(nodes.Get(0), nodes.Get(i));
+
+    ndn::StackHelper ndnHelper;
+    ndnHelper.SetForwardingStrategy(strategy);
+    ndnHelper.InstallAll();
+
+    ndn::GlobalRoutingHelper routingHelper;
+    routingHelper.InstallAll();
+
+    ndn::AppHelper consumerHelper("ns3::ndn::WikiClient");
+    consumerHelper.SetPrefix("/prefix");
+    consumerHelper.SetAttribute("Frequency", DoubleValue(frequency));
+    for (uint32_t i = 2; i < nodes.GetN(); i++)
+      consumerHelper.Install(nodes.Get(i));
+
+    ndn::AppHelper producerHelper("ns3::ndn::WikiProducer");
+    producerHelper.SetPrefix("/prefix");
+    producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+    producerHelper.Install(nodes.Get(1));
+
+    routingHelper.AddOrigins("/prefix", nodes.Get(1));
+    routingHelper.CalculateRoutes();
+
+    Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::ndn::WikiClient/TransmittedInterests",
+                                  MakeCallback(&CountInterest));
+
+    Simulator::Stop(Seconds(stop));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "strategy=" << strategy
+              << " degree=" << degree
+              << " interests=" << g_interests
+              << " wallclock=" << elapsed.count() << "s"
+              << " perInterest=" << (g_interests ? elapsed.count() * 1e9 / g_interests : 0) << "ns"
+              << std::endl;
+
+#ifdef NDN_HOTPATH_PROFILING
+    ndn::HotPathProfiler::Print(std::cout);
+#endif
+
+    ndn::MemoryAccounting::SamplePit(192);
+    ndn::MemoryAccounting::Print(std::cout);
+
+    Simulator::Destroy();
+
+    return 0;
+}
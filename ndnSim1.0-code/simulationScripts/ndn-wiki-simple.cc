@@ -21,6 +21,7 @@
 // Simple simulation script to test the wiki-pagetitle class and the consumer/producer apps making use of it
 
 #include "ns3/wiki-pagetitle.h"
+#include "ns3/event-log.h"
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/point-to-point-module.h"
@@ -37,7 +38,10 @@ main(int argc, char* argv[])
   Config::SetDefault("ns3::DropTailQueue::MaxPackets", StringValue("20"));
 
   // Read optional command-line parameters (e.g., enable visualizer with ./waf --run=<> --visualize
+  std::string events = "";
+
     CommandLine cmd;
+    cmd.AddValue("events", "File of the binary event log of the applications, to be read with columnar-trace-dump", events);
     cmd.Parse(argc, argv);
 
     WikiPageTitles::Instance()->load(argv[1]);
@@ -70,9 +74,13 @@ main(int argc, char* argv[])
     producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
     producerHelper.Install(nodes.Get(2)); // last node
 
+    if (!events.empty())
+      ndn::EventLog::Open(events);
+
     Simulator::Stop(Seconds(20.0));
 
     Simulator::Run();
+    ndn::EventLog::Close();
     Simulator::Destroy();
 
     return 0;
@@ -0,0 +1,225 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "face-stats.h"
+
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+FaceStats::FaceStats (uint32_t counters, MemorySubsystem memory)
+  : m_counters (counters)
+  , m_faces (0)
+  , m_engine (STATS_RESET)
+  , m_window (Seconds (10))
+  , m_subIntervals (10)
+  , m_currentSlot (0)
+  , m_gauges (counters, false)
+  , m_memory (memory)
+  , m_memoryBytes (0)
+{
+}
+
+FaceStats::~FaceStats ()
+{
+  if (m_memoryBytes > 0)
+    MemoryAccounting::Deallocate (m_memory, m_memoryBytes);
+}
+
+// The arrays only grow with the number of faces (and once with the sub-intervals at
+// Start), so they are reported when resized rather than through an allocator
+void
+FaceStats::AccountMemory ()
+{
+  uint64_t bytes = (m_values.capacity () + m_history.capacity ()) * sizeof (double);
+  if (bytes > m_memoryBytes)
+    MemoryAccounting::Allocate (m_memory, bytes - m_memoryBytes);
+  else if (bytes < m_memoryBytes)
+    MemoryAccounting::Deallocate (m_memory, m_memoryBytes - bytes);
+  m_memoryBytes = bytes;
+}
+
+void
+FaceStats::SetEngine (std::string engine)
+{
+  if (engine == "sliding")
+    m_engine = STATS_SLIDING;
+  else if (engine == "ewma")
+    m_engine = STATS_EWMA;
+  else
+    {
+      NS_ASSERT_MSG (engine == "reset", "Unknown statistics engine " << engine);
+      m_engine = STATS_RESET;
+    }
+}
+
+std::string
+FaceStats::GetEngine () const
+{
+  switch (m_engine)
+    {
+    case STATS_SLIDING:
+      return "sliding";
+    case STATS_EWMA:
+      return "ewma";
+    default:
+      return "reset";
+    }
+}
+
+void
+FaceStats::Start (uint32_t nodeId, Time window, uint32_t subIntervals, RollCallback onRoll)
+{
+  NS_ASSERT_MSG (subIntervals > 0, "The time window must have at least one sub-interval");
+
+  m_window = window;
+  m_subIntervals = subIntervals;
+  m_currentSlot = 0;
+  m_onRoll = onRoll;
+  m_lastReset = Simulator::Now ();
+
+  if (m_engine == STATS_SLIDING)
+    m_history.assign (m_faces * m_subIntervals * m_counters, 0.0);
+  AccountMemory ();
+
+  m_rollEvent.Cancel ();
+  m_rollEvent = Simulator::ScheduleWithContext (nodeId, GetPeriod (), &FaceStats::Roll, this);
+}
+
+void
+FaceStats::Stop ()
+{
+  m_rollEvent.Cancel ();
+  m_onRoll = RollCallback ();
+}
+
+void
+FaceStats::AddFace (uint32_t faceId)
+{
+  if (faceId >= m_faces)
+    {
+      m_faces = faceId + 1;
+      m_values.resize (m_faces * m_counters);
+      if (m_engine == STATS_SLIDING)
+        m_history.resize (m_faces * m_subIntervals * m_counters);
+      AccountMemory ();
+    }
+  ClearFace (faceId);
+}
+
+void
+FaceStats::ClearFace (uint32_t faceId)
+{
+  if (faceId >= m_faces)
+    return;
+
+  std::fill (m_values.begin () + faceId * m_counters,
+             m_values.begin () + (faceId + 1) * m_counters, 0.0);
+  if (m_engine == STATS_SLIDING)
+    std::fill (m_history.begin () + faceId * m_subIntervals * m_counters,
+               m_history.begin () + (faceId + 1) * m_subIntervals * m_counters, 0.0);
+}
+
+void
+FaceStats::SetGauge (uint32_t counter)
+{
+  NS_ASSERT (counter < m_counters);
+  m_gauges[counter] = true;
+}
+
+Time
+FaceStats::GetPeriod () const
+{
+  if (m_engine == STATS_RESET)
+    return m_window;
+
+  return Seconds (m_window.ToDouble (Time::S) / m_subIntervals);
+}
+
+double
+FaceStats::GetDecay () const
+{
+  return (m_engine == STATS_RESET) ? 0.0 : 1.0 - 1.0 / m_subIntervals;
+}
+
+// With the reset engine the counters only cover the time elapsed since the last reset
+double
+FaceStats::GetElapsed () const
+{
+  if (m_engine == STATS_RESET)
+    return (Simulator::Now () - m_lastReset).ToDouble (Time::S);
+
+  return m_window.ToDouble (Time::S);
+}
+
+// The strategy is notified before the step, so that it sees the counters of the
+// window which is ending (with the reset engine they are cleared right after)
+void
+FaceStats::Roll ()
+{
+  if (!m_onRoll.IsNull ())
+    m_onRoll ();
+
+  switch (m_engine)
+    {
+    case STATS_RESET:
+      std::fill (m_values.begin (), m_values.end (), 0.0);
+      m_lastReset = Simulator::Now ();
+      break;
+
+    case STATS_SLIDING:
+      // the oldest sub-interval leaves the window and its slot is reused for the next one
+      m_currentSlot = (m_currentSlot + 1) % m_subIntervals;
+      for (uint32_t id = 0; id < m_faces; id++)
+        {
+          double *slot = &m_history[(id * m_subIntervals + m_currentSlot) * m_counters];
+          double *values = &m_values[id * m_counters];
+          for (uint32_t c = 0; c < m_counters; c++)
+            {
+              values[c] -= slot[c]; // always 0 for the gauges, which are not windowed
+              slot[c] = 0;
+            }
+        }
+      break;
+
+    case STATS_EWMA:
+      {
+        double decay = GetDecay ();
+        for (uint32_t id = 0; id < m_faces; id++)
+          {
+            double *values = &m_values[id * m_counters];
+            for (uint32_t c = 0; c < m_counters; c++)
+              if (!m_gauges[c])
+                values[c] *= decay;
+          }
+        break;
+      }
+    }
+
+  m_rollEvent = Simulator::Schedule (GetPeriod (), &FaceStats::Roll, this);
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,198 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef FACE_STATS_H
+#define FACE_STATS_H
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/assert.h"
+
+#include "memory-accounting.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+// Statistics engines for the per-face counters
+//  - reset: counters are cleared every time window
+//  - sliding: counters are the sum over the last time window, which is split in
+//    sub-intervals kept in a per-face ring buffer
+//  - ewma: counters are scaled by (1 - 1/subIntervals) every sub-interval, that is,
+//    an EWMA of the per sub-interval counts on the same scale as the sliding window
+enum StatsEngine { STATS_RESET, STATS_SLIDING, STATS_EWMA };
+
+/**
+ * @brief Per-face counters shared by the mitigation strategies (Poseidon, SBP, ...)
+ *
+ * Every strategy defines its own set of counters (e.g., Interests received, Data
+ * returned, PIT usage) by index. The counters of all the faces are kept in one flat
+ * array indexed by face id and counter index, so that an update costs O(1) and touches
+ * the counters of a single face. A single event per node rolls the statistics over
+ * according to the engine, the strategy is notified at every roll-over, just before the
+ * counters are cleared or decayed, to do its own periodic work on the statistics of the
+ * window which ends without scheduling further events.
+ *
+ * Counters can be declared gauges, i.e., levels such as the PIT entries held by a face
+ * rather than counts of events: the sliding and ewma engines leave them untouched, as
+ * their value is not a sum over the time window. The reset engine clears them along
+ * with the others, as the original Poseidon did.
+ */
+class FaceStats
+{
+public:
+  typedef Callback<void> RollCallback;
+
+  /**
+   * @param counters number of counters per face
+   * @param memory subsystem the memory of the counters is reported to
+   */
+  FaceStats (uint32_t counters, MemorySubsystem memory = MEM_FACE_STATS);
+
+  ~FaceStats ();
+
+  void
+  SetEngine (std::string engine);
+
+  std::string
+  GetEngine () const;
+
+  StatsEngine
+  GetEngineType () const { return m_engine; }
+
+  /**
+   * @brief Starts rolling the statistics over
+   * @param nodeId context of the roll-over events
+   * @param window statistics time window
+   * @param subIntervals number of sub-intervals of the window (sliding and ewma engines)
+   * @param onRoll called at every roll-over, before the counters are cleared or decayed
+   */
+  void
+  Start (uint32_t nodeId, Time window, uint32_t subIntervals, RollCallback onRoll);
+
+  void
+  Stop ();
+
+  /**
+   * @brief Makes room for a face, whose counters are cleared
+   */
+  void
+  AddFace (uint32_t faceId);
+
+  void
+  ClearFace (uint32_t faceId);
+
+  /**
+   * @brief Declares a counter as a gauge, which is neither windowed nor decayed
+   */
+  void
+  SetGauge (uint32_t counter);
+
+  inline void
+  Add (uint32_t faceId, uint32_t counter, double value);
+
+  inline double
+  Get (uint32_t faceId, uint32_t counter) const;
+
+  /**
+   * @brief Ratio of two counters of the same face, 0 if the denominator is 0
+   */
+  inline double
+  Ratio (uint32_t faceId, uint32_t numerator, uint32_t denominator) const;
+
+  /**
+   * @brief Period of the roll-over events
+   */
+  Time
+  GetPeriod () const;
+
+  /**
+   * @brief Factor the counters are scaled by at each roll-over, for the strategy state
+   * which has to decay along with the counters (0 with the reset engine)
+   */
+  double
+  GetDecay () const;
+
+  /**
+   * @brief Time covered by the counters, in seconds
+   */
+  double
+  GetElapsed () const;
+
+  uint32_t
+  GetNFaces () const { return m_faces; }
+
+private:
+  void
+  Roll ();
+
+  void
+  AccountMemory ();
+
+private:
+  uint32_t m_counters; // counters per face
+  uint32_t m_faces;
+  StatsEngine m_engine;
+  Time m_window;
+  uint32_t m_subIntervals;
+  uint32_t m_currentSlot;
+  Time m_lastReset; // reset engine, start of the current time window
+
+  std::vector<double> m_values; // m_counters per face
+  std::vector<double> m_history; // sliding engine, m_counters x m_subIntervals slots per face
+  std::vector<bool> m_gauges; // m_counters, true for the gauges
+  MemorySubsystem m_memory;
+  uint64_t m_memoryBytes; // capacity of the arrays, as reported
+
+  EventId m_rollEvent;
+  RollCallback m_onRoll;
+};
+
+inline void
+FaceStats::Add (uint32_t faceId, uint32_t counter, double value)
+{
+  NS_ASSERT_MSG (faceId < m_faces, "Face " << faceId << " was never added to the statistics");
+  m_values[faceId * m_counters + counter] += value;
+  if (m_engine == STATS_SLIDING && !m_gauges[counter])
+    m_history[(faceId * m_subIntervals + m_currentSlot) * m_counters + counter] += value;
+}
+
+inline double
+FaceStats::Get (uint32_t faceId, uint32_t counter) const
+{
+  return m_values[faceId * m_counters + counter];
+}
+
+inline double
+FaceStats::Ratio (uint32_t faceId, uint32_t numerator, uint32_t denominator) const
+{
+  double den = Get (faceId, denominator);
+  return (den != 0) ? Get (faceId, numerator) / den : 0;
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // FACE_STATS_H
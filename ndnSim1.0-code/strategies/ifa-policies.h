@@ -0,0 +1,350 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef IFA_POLICIES_H
+#define IFA_POLICIES_H
+
+#include "ns3/type-id.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+#include "face-stats.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+// Policies IfaStrategy (see ifa-strategy.h) is composed of. All the calls made on the
+// forwarding path are non-virtual and defined here, so that they are inlined in the
+// strategy.
+//
+// A statistics policy is a FaceStats running a fixed engine:
+//   Stats (uint32_t counters); static std::string GetName ();
+//
+// A detection policy defines its counters and updates them:
+//   enum { ..., CNT_MAX };
+//   static std::string GetName ();
+//   static TypeId AddAttributes (TypeId tid);
+//   static void SetGauges (FaceStats &);                // declares its gauge counters
+//   void SetPitCapacity (double entries);
+//   void OnForwarded (FaceStats &, uint32_t inFaceId);   // Interest sent upstream
+//   void OnPitEntry (FaceStats &, uint32_t inFaceId);    // PIT entry created
+//   void OnSatisfied (FaceStats &, uint32_t inFaceId);   // for each incoming face
+//   void OnTimedOut (FaceStats &, uint32_t inFaceId);    // for each incoming face
+//   bool IsAttacked (const FaceStats &, uint32_t faceId) const;
+//   double GetGoodRate (const FaceStats &, uint32_t faceId) const; // Data per second
+//
+// A reaction policy decides on the Interests received on a detected face:
+//   static std::string GetName ();
+//   static TypeId AddAttributes (TypeId tid);
+//   void AddFace (uint32_t faceId);
+//   void RemoveFace (uint32_t faceId);                   // drops the state of the face
+//   void OnDetection (uint32_t faceId);                  // detection rising edge
+//   template<class Detector>
+//   bool Admit (const Detector &, const FaceStats &, uint32_t faceId);
+//
+// Attributes of the policies are registered on the TypeId of the strategy, which
+// inherits from the detection and reaction policies.
+
+////////////////////////////////////////////////////////////////////////////
+// Statistics policies
+
+class ResetStats : public FaceStats
+{
+public:
+  ResetStats (uint32_t counters) : FaceStats (counters) { SetEngine ("reset"); }
+  static std::string GetName () { return "Reset"; }
+};
+
+class SlidingStats : public FaceStats
+{
+public:
+  SlidingStats (uint32_t counters) : FaceStats (counters) { SetEngine ("sliding"); }
+  static std::string GetName () { return "Sliding"; }
+};
+
+class EwmaStats : public FaceStats
+{
+public:
+  EwmaStats (uint32_t counters) : FaceStats (counters) { SetEngine ("ewma"); }
+  static std::string GetName () { return "Ewma"; }
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Detection policies
+
+/**
+ * @brief Poseidon's ConditionA: the ratio of Interests to Data of the face (ISR) is
+ * above omega and the PIT entries created by its Interests are above rho times the PIT
+ * size. Unlike Poseidon, thresholds are static and entries are released on timeout too.
+ */
+class IsrPurDetector
+{
+public:
+  enum { CNT_INTERESTS = 0, CNT_CONTENTS, CNT_PIT_USAGE, CNT_MAX };
+
+  IsrPurDetector () : m_omega (3.0), m_rho (0.125), m_pitCapacity (0) { }
+
+  static std::string GetName () { return "IsrPur"; }
+
+  static TypeId
+  AddAttributes (TypeId tid)
+  {
+    return tid
+      .AddAttribute ("OmegaThreshold", "Threshold for the ISR",
+                     DoubleValue (3.0),
+                     MakeDoubleAccessor (&IsrPurDetector::m_omega),
+                     MakeDoubleChecker<double> ())
+      .AddAttribute ("RhoThreshold", "Threshold for the PIT usage expressed as percentage of the max pit size",
+                     DoubleValue (0.125),
+                     MakeDoubleAccessor (&IsrPurDetector::m_rho),
+                     MakeDoubleChecker<double> ());
+  }
+
+  // the PIT entries held by a face are a level, not a count over the window
+  static void SetGauges (FaceStats &stats) { stats.SetGauge (CNT_PIT_USAGE); }
+
+  void SetPitCapacity (double entries) { m_pitCapacity = entries; }
+
+  void OnForwarded (FaceStats &stats, uint32_t faceId) { stats.Add (faceId, CNT_INTERESTS, 1); }
+  void OnPitEntry (FaceStats &stats, uint32_t faceId) { stats.Add (faceId, CNT_PIT_USAGE, 1); }
+
+  void
+  OnSatisfied (FaceStats &stats, uint32_t faceId)
+  {
+    stats.Add (faceId, CNT_CONTENTS, 1);
+    OnTimedOut (stats, faceId);
+  }
+
+  void
+  OnTimedOut (FaceStats &stats, uint32_t faceId)
+  {
+    // the reset engine may have cleared the usage since the entry was created
+    stats.Add (faceId, CNT_PIT_USAGE, -std::min (1.0, stats.Get (faceId, CNT_PIT_USAGE)));
+  }
+
+  bool
+  IsAttacked (const FaceStats &stats, uint32_t faceId) const
+  {
+    return stats.Ratio (faceId, CNT_INTERESTS, CNT_CONTENTS) > m_omega &&
+      stats.Get (faceId, CNT_PIT_USAGE) > m_rho * m_pitCapacity;
+  }
+
+  double
+  GetGoodRate (const FaceStats &stats, uint32_t faceId) const
+  {
+    double window = stats.GetElapsed ();
+    return (window > 0) ? stats.Get (faceId, CNT_CONTENTS) / window : 0;
+  }
+
+protected:
+  double m_omega;
+  double m_rho;
+  double m_pitCapacity;
+};
+
+/**
+ * @brief SBP-like condition: less than a threshold fraction of the Interests received
+ * on the face which left the PIT got satisfied, out of at least MinSamples
+ */
+class SatisfactionDetector
+{
+public:
+  enum { CNT_SATISFIED = 0, CNT_UNSATISFIED, CNT_MAX };
+
+  SatisfactionDetector () : m_threshold (0.5), m_minSamples (10) { }
+
+  static std::string GetName () { return "Satisfaction"; }
+
+  static TypeId
+  AddAttributes (TypeId tid)
+  {
+    return tid
+      .AddAttribute ("SatisfactionThreshold", "A face is detected when the satisfied fraction of its Interests is below this value",
+                     DoubleValue (0.5),
+                     MakeDoubleAccessor (&SatisfactionDetector::m_threshold),
+                     MakeDoubleChecker<double> (0.0, 1.0))
+      .AddAttribute ("MinSamples", "Min number of Interests satisfied or timed out before a face can be detected",
+                     DoubleValue (10),
+                     MakeDoubleAccessor (&SatisfactionDetector::m_minSamples),
+                     MakeDoubleChecker<double> (0.0));
+  }
+
+  static void SetGauges (FaceStats &) { }
+
+  void SetPitCapacity (double) { }
+
+  void OnForwarded (FaceStats &, uint32_t) { }
+  void OnPitEntry (FaceStats &, uint32_t) { }
+  void OnSatisfied (FaceStats &stats, uint32_t faceId) { stats.Add (faceId, CNT_SATISFIED, 1); }
+  void OnTimedOut (FaceStats &stats, uint32_t faceId) { stats.Add (faceId, CNT_UNSATISFIED, 1); }
+
+  bool
+  IsAttacked (const FaceStats &stats, uint32_t faceId) const
+  {
+    double satisfied = stats.Get (faceId, CNT_SATISFIED);
+    double total = satisfied + stats.Get (faceId, CNT_UNSATISFIED);
+    return total >= m_minSamples && total > 0 && satisfied < m_threshold * total;
+  }
+
+  double
+  GetGoodRate (const FaceStats &stats, uint32_t faceId) const
+  {
+    double window = stats.GetElapsed ();
+    return (window > 0) ? stats.Get (faceId, CNT_SATISFIED) / window : 0;
+  }
+
+protected:
+  double m_threshold;
+  double m_minSamples;
+};
+
+////////////////////////////////////////////////////////////////////////////
+// Reaction policies
+
+/**
+ * @brief Detection only, every Interest is forwarded
+ */
+class MonitorReaction
+{
+public:
+  static std::string GetName () { return "Monitor"; }
+  static TypeId AddAttributes (TypeId tid) { return tid; }
+
+  void AddFace (uint32_t) { }
+  void RemoveFace (uint32_t) { }
+  void OnDetection (uint32_t) { }
+
+  template<class Detector>
+  bool Admit (const Detector &, const FaceStats &, uint32_t) { return true; }
+};
+
+/**
+ * @brief Every Interest received on a detected face is dropped
+ */
+class DropReaction
+{
+public:
+  static std::string GetName () { return "Drop"; }
+  static TypeId AddAttributes (TypeId tid) { return tid; }
+
+  void AddFace (uint32_t) { }
+  void RemoveFace (uint32_t) { }
+  void OnDetection (uint32_t) { }
+
+  template<class Detector>
+  bool Admit (const Detector &, const FaceStats &, uint32_t) { return false; }
+};
+
+/**
+ * @brief Interests received on a detected face are policed by a token bucket whose rate
+ * is ShapingFactor times the rate of Data returned to the face (as Poseidon's 'shape')
+ */
+class TokenBucketReaction
+{
+public:
+  TokenBucketReaction () : m_shapingFactor (1.0), m_minShapingRate (1.0), m_bucketDepth (10.0) { }
+
+  static std::string GetName () { return "TokenBucket"; }
+
+  static TypeId
+  AddAttributes (TypeId tid)
+  {
+    return tid
+      .AddAttribute ("ShapingFactor", "Rate of the token bucket of a detected face, as a multiple of the rate of Data returned to that face",
+                     DoubleValue (1.0),
+                     MakeDoubleAccessor (&TokenBucketReaction::m_shapingFactor),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("MinShapingRate", "Minimum rate (Interests per second) of the token bucket of a detected face",
+                     DoubleValue (1.0),
+                     MakeDoubleAccessor (&TokenBucketReaction::m_minShapingRate),
+                     MakeDoubleChecker<double> (0.0))
+      .AddAttribute ("BucketDepth", "Max number of tokens of the token bucket of a detected face",
+                     DoubleValue (10.0),
+                     MakeDoubleAccessor (&TokenBucketReaction::m_bucketDepth),
+                     MakeDoubleChecker<double> (1.0));
+  }
+
+  void
+  AddFace (uint32_t faceId)
+  {
+    if (faceId >= m_buckets.size ())
+      m_buckets.resize (faceId + 1);
+    m_buckets[faceId] = Bucket ();
+  }
+
+  void
+  RemoveFace (uint32_t faceId)
+  {
+    if (faceId < m_buckets.size ())
+      m_buckets[faceId] = Bucket ();
+  }
+
+  void
+  OnDetection (uint32_t faceId)
+  {
+    m_buckets[faceId].tokens = m_bucketDepth;
+    m_buckets[faceId].lastRefill = Simulator::Now ();
+  }
+
+  template<class Detector>
+  bool
+  Admit (const Detector &detector, const FaceStats &stats, uint32_t faceId)
+  {
+    Bucket &bucket = m_buckets[faceId];
+    Time now = Simulator::Now ();
+
+    double rate = std::max (m_minShapingRate, m_shapingFactor * detector.GetGoodRate (stats, faceId));
+    bucket.tokens = std::min (m_bucketDepth,
+                              bucket.tokens + rate * (now - bucket.lastRefill).ToDouble (Time::S));
+    bucket.lastRefill = now;
+
+    if (bucket.tokens < 1.0)
+      return false;
+
+    bucket.tokens -= 1.0;
+    return true;
+  }
+
+protected:
+  struct Bucket
+  {
+    Bucket () : tokens (0) { }
+
+    double tokens;
+    Time lastRefill;
+  };
+
+  double m_shapingFactor;
+  double m_minShapingRate;
+  double m_bucketDepth;
+  std::vector<Bucket> m_buckets;
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // IFA_POLICIES_H
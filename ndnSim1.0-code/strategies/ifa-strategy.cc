@@ -0,0 +1,248 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "ifa-strategy.h"
+#include "pit-telemetry.h"
+
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-pit-entry.h"
+#include "interest-type.h"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+
+#include <boost/foreach.hpp>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+template<class Stats, class Detector, class Reaction>
+LogComponent IfaStrategy<Stats, Detector, Reaction>::g_log = LogComponent (IfaStrategy<Stats, Detector, Reaction>::GetLogName ().c_str ());
+
+template<class Stats, class Detector, class Reaction>
+std::string
+IfaStrategy<Stats, Detector, Reaction>::GetLogName ()
+{
+  return super::GetLogName ()+".Ifa."+Stats::GetName ()+"."+Detector::GetName ()+"."+Reaction::GetName ();
+}
+
+template<class Stats, class Detector, class Reaction>
+TypeId
+IfaStrategy<Stats, Detector, Reaction>::GetTypeId (void)
+{
+  static TypeId tid = Reaction::AddAttributes (Detector::AddAttributes (
+    TypeId ((super::GetTypeId ().GetName ()+"::Ifa::"+Stats::GetName ()+"::"+Detector::GetName ()+"::"+Reaction::GetName ()).c_str ())
+    .SetGroupName ("Ndn")
+    .template SetParent <super> ()
+    .template AddConstructor <IfaStrategy<Stats, Detector, Reaction> > ()
+
+    .AddAttribute ("TimeWindow", "Time window of the statistics",
+                   StringValue ("10s"),
+                   MakeTimeAccessor (&IfaStrategy<Stats, Detector, Reaction>::m_timeInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("SubIntervals", "Number of sub-intervals the time window is split in by the sliding and ewma statistics",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&IfaStrategy<Stats, Detector, Reaction>::m_subIntervals),
+                   MakeUintegerChecker<uint32_t> (1))
+
+    .AddTraceSource ("Detection", "Fired whenever a face starts or stops being detected",
+                     MakeTraceSourceAccessor (&IfaStrategy<Stats, Detector, Reaction>::m_onDetection))
+    ));
+  return tid;
+}
+
+template<class Stats, class Detector, class Reaction>
+IfaStrategy<Stats, Detector, Reaction>::IfaStrategy ()
+  : m_started (false)
+  , m_stats (Detector::CNT_MAX)
+  , m_timeInterval (Seconds (10))
+  , m_subIntervals (10)
+{
+  Detector::SetGauges (m_stats);
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::NotifyNewAggregate ()
+{
+  super::NotifyNewAggregate ();
+
+  if (!m_started && m_pit != 0 && m_fib != 0 && GetObject<Node> () != 0)
+    {
+      m_started = true;
+      Detector::SetPitCapacity (PitTelemetry::GetMaxSize (m_pit));
+      // detection is evaluated at every Interest, nothing to do at the roll-over
+      m_stats.Start (GetObject<Node> ()->GetId (), m_timeInterval, m_subIntervals,
+                     FaceStats::RollCallback ());
+    }
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::DoDispose ()
+{
+  m_stats.Stop ();
+
+  super::DoDispose ();
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::AddFace (Ptr<Face> face)
+{
+  super::AddFace (face);
+
+  uint32_t id = face->GetId ();
+  if (id >= m_detected.size ())
+    m_detected.resize (id + 1);
+  m_detected[id] = false;
+
+  m_stats.AddFace (id);
+  Reaction::AddFace (id);
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::RemoveFace (Ptr<Face> face)
+{
+  // face ids may be reused, the next face must not inherit the detection
+  uint32_t id = face->GetId ();
+  if (id < m_detected.size () && m_detected[id])
+    {
+      m_detected[id] = false;
+      m_onDetection (face, false);
+    }
+
+  m_stats.ClearFace (id);
+  Reaction::RemoveFace (id);
+
+  super::RemoveFace (face);
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::OnInterest (Ptr<Face> face,
+                                                    Ptr<Interest> interest)
+{
+  uint32_t id = face->GetId ();
+  bool detected = Detector::IsAttacked (m_stats, id);
+  if (detected != m_detected[id])
+    {
+      NS_LOG_INFO ("Detection on " << *face << ": " << detected);
+      m_detected[id] = detected;
+      if (detected)
+        Reaction::OnDetection (id);
+      m_onDetection (face, detected);
+    }
+
+  if (detected && !Reaction::Admit (*this, m_stats, id))
+    {
+      // reported as received and dropped as the parent class does with its own drops, so
+      // that the per-face tracers know the face before the type is reported
+      m_inInterests (interest, face);
+      m_dropInterests (interest, face);
+      interestTypesTrace (GetInterestType (interest), 0);
+      return;
+    }
+
+  super::OnInterest (face, interest);
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::DidSendOutInterest (Ptr<Face> inFace,
+                                                            Ptr<Face> outFace,
+                                                            Ptr<const Interest> interest,
+                                                            Ptr<pit::Entry> pitEntry)
+{
+  super::DidSendOutInterest (inFace, outFace, interest, pitEntry);
+  Detector::OnForwarded (m_stats, inFace->GetId ());
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::DidCreatePitEntry (Ptr<Face> inFace,
+                                                           Ptr<const Interest> interest,
+                                                           Ptr<pit::Entry> pitEntry)
+{
+  super::DidCreatePitEntry (inFace, interest, pitEntry);
+  Detector::OnPitEntry (m_stats, inFace->GetId ());
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::WillSatisfyPendingInterest (Ptr<Face> inFace,
+                                                                    Ptr<pit::Entry> pitEntry)
+{
+  BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
+    {
+      Detector::OnSatisfied (m_stats, incoming.m_face->GetId ());
+    }
+
+  super::WillSatisfyPendingInterest (inFace, pitEntry);
+}
+
+template<class Stats, class Detector, class Reaction>
+void
+IfaStrategy<Stats, Detector, Reaction>::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry)
+{
+  BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
+    {
+      Detector::OnTimedOut (m_stats, incoming.m_face->GetId ());
+    }
+
+  super::WillEraseTimedOutPendingInterest (pitEntry);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Registered combinations, add here the ones to be benchmarked
+
+// Poseidon's detection with the original statistics and reaction
+template class IfaStrategy<ResetStats, IsrPurDetector, DropReaction>;
+typedef IfaStrategy<ResetStats, IsrPurDetector, DropReaction> IfaResetIsrPurDrop;
+NS_OBJECT_ENSURE_REGISTERED (IfaResetIsrPurDrop);
+
+template class IfaStrategy<EwmaStats, IsrPurDetector, DropReaction>;
+typedef IfaStrategy<EwmaStats, IsrPurDetector, DropReaction> IfaEwmaIsrPurDrop;
+NS_OBJECT_ENSURE_REGISTERED (IfaEwmaIsrPurDrop);
+
+template class IfaStrategy<EwmaStats, IsrPurDetector, TokenBucketReaction>;
+typedef IfaStrategy<EwmaStats, IsrPurDetector, TokenBucketReaction> IfaEwmaIsrPurTokenBucket;
+NS_OBJECT_ENSURE_REGISTERED (IfaEwmaIsrPurTokenBucket);
+
+template class IfaStrategy<SlidingStats, IsrPurDetector, MonitorReaction>;
+typedef IfaStrategy<SlidingStats, IsrPurDetector, MonitorReaction> IfaSlidingIsrPurMonitor;
+NS_OBJECT_ENSURE_REGISTERED (IfaSlidingIsrPurMonitor);
+
+template class IfaStrategy<EwmaStats, SatisfactionDetector, DropReaction>;
+typedef IfaStrategy<EwmaStats, SatisfactionDetector, DropReaction> IfaEwmaSatisfactionDrop;
+NS_OBJECT_ENSURE_REGISTERED (IfaEwmaSatisfactionDrop);
+
+template class IfaStrategy<EwmaStats, SatisfactionDetector, TokenBucketReaction>;
+typedef IfaStrategy<EwmaStats, SatisfactionDetector, TokenBucketReaction> IfaEwmaSatisfactionTokenBucket;
+NS_OBJECT_ENSURE_REGISTERED (IfaEwmaSatisfactionTokenBucket);
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
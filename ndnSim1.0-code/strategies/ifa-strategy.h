@@ -0,0 +1,119 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef IFA_STRATEGY_H
+#define IFA_STRATEGY_H
+
+#include "ns3/traced-callback.h"
+#include "ns3/ndnSIM/model/fw/best-route.h"
+
+#include "ifa-policies.h"
+
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+/**
+ * \ingroup ndn-fw
+ * \brief Interest flooding mitigation composed at compile time
+ *
+ * The strategy forwards as BestRoute and is composed of a statistics policy, a
+ * detection policy and a reaction policy (see ifa-policies.h), for instance
+ * IfaStrategy<EwmaStats, IsrPurDetector, TokenBucketReaction>. The policies are
+ * reached through non-virtual calls, so new combinations of defenses can be
+ * benchmarked without writing a new strategy and without indirect calls on the
+ * forwarding path.
+ *
+ * The combination is registered as
+ * ns3::ndn::fw::BestRoute::Ifa::<Stats>::<Detector>::<Reaction>, e.g.,
+ * ns3::ndn::fw::BestRoute::Ifa::Ewma::IsrPur::TokenBucket.
+ */
+template<class Stats, class Detector, class Reaction>
+class IfaStrategy :
+    public BestRoute,
+    public Detector,
+    public Reaction
+{
+private:
+  typedef BestRoute super;
+
+public:
+  static TypeId
+  GetTypeId ();
+
+  static std::string
+  GetLogName ();
+
+  IfaStrategy ();
+
+  virtual void
+  OnInterest (Ptr<Face> face,
+              Ptr<Interest> interest);
+
+  virtual void
+  AddFace (Ptr<Face> face);
+
+  virtual void
+  RemoveFace (Ptr<Face> face);
+
+  virtual void
+  WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry);
+
+protected:
+  virtual void
+  NotifyNewAggregate ();
+
+  virtual void
+  DoDispose ();
+
+  virtual void
+  DidSendOutInterest (Ptr<Face> inFace,
+                      Ptr<Face> outFace,
+                      Ptr<const Interest> interest,
+                      Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  DidCreatePitEntry (Ptr<Face> inFace,
+                     Ptr<const Interest> interest,
+                     Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  WillSatisfyPendingInterest (Ptr<Face> inFace,
+                              Ptr<pit::Entry> pitEntry);
+
+private:
+  static LogComponent g_log;
+
+  bool m_started;
+  Stats m_stats;
+  Time m_timeInterval;
+  uint32_t m_subIntervals;
+  std::vector<bool> m_detected; // by face id
+
+  TracedCallback<Ptr<const Face>, bool /* detected */ > m_onDetection;
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // IFA_STRATEGY_H
@@ -0,0 +1,52 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef INTEREST_TYPE_H
+#define INTEREST_TYPE_H
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndnSIM/utils/interest-type-tag.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+/**
+ * @brief Type of an Interest as reported to the InterestTypes trace of the strategies
+ *
+ * The type is the one set by the application in the InterestTypeTag. Interests with no
+ * tag are accounted as legitimate ones (type 1).
+ */
+inline uint32_t
+GetInterestType (Ptr<const Interest> interest)
+{
+  InterestTypeTag interestTypeTag;
+  if (interest->GetPayload ()->PeekPacketTag (interestTypeTag))
+    return interestTypeTag.Get ();
+  return 1;
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // INTEREST_TYPE_H
@@ -0,0 +1,100 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "pit-telemetry.h"
+
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+PitTelemetry::PitTelemetry ()
+  : m_capacity (0)
+  , m_unitCost (true)
+  , m_occupancy (0)
+  , m_entries (0)
+  , m_step (0)
+  , m_lastLevel (0)
+{
+}
+
+void
+PitTelemetry::Start (Ptr<Pit> pit, uint32_t nodeId, double capacity, Time samplePeriod, double step, UsageCallback sink,
+                     bool unitCost/* = true*/)
+{
+  m_pit = pit;
+  m_capacity = capacity;
+  m_unitCost = unitCost;
+  m_samplePeriod = samplePeriod;
+  m_step = step;
+  m_sink = sink;
+
+  m_sampleEvent.Cancel ();
+  if (!m_samplePeriod.IsZero ())
+    m_sampleEvent = Simulator::ScheduleWithContext (nodeId, m_samplePeriod, &PitTelemetry::Sample, this);
+}
+
+void
+PitTelemetry::Stop ()
+{
+  m_sampleEvent.Cancel ();
+  m_pit = 0;
+  m_sink = UsageCallback ();
+}
+
+// MaxSize is an unsigned attribute, no need to go through its string representation
+uint32_t
+PitTelemetry::GetMaxSize (Ptr<Pit> pit)
+{
+  UintegerValue maxSize;
+  pit->GetAttribute ("MaxSize", maxSize);
+  return maxSize.Get ();
+}
+
+void
+PitTelemetry::Sample ()
+{
+  // entries erased without the strategy being notified (e.g., by the PIT policy)
+  uint32_t entries = m_pit->GetSize ();
+  if (m_unitCost)
+    m_occupancy = entries;
+  else if (m_entries > 0)
+    m_occupancy *= (double)entries / m_entries;
+  m_entries = entries;
+
+  Report ();
+  m_sampleEvent = Simulator::Schedule (m_samplePeriod, &PitTelemetry::Sample, this);
+}
+
+void
+PitTelemetry::Report ()
+{
+  if (m_step > 0 && m_capacity != 0)
+    m_lastLevel = static_cast<int64_t> (std::floor (m_occupancy / m_capacity / m_step));
+
+  if (!m_sink.IsNull ())
+    m_sink (GetUsage (), m_entries);
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,152 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef PIT_TELEMETRY_H
+#define PIT_TELEMETRY_H
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+#include "ns3/ndn-pit.h"
+
+#include <cmath>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+/**
+ * @brief PIT occupancy shared by the strategies feeding a PITUsage trace source
+ *
+ * The strategy reports every entry it creates and every entry satisfied or timed out,
+ * together with its cost (1, or its estimated bytes), so the occupancy is known at any
+ * time in O(1). The usage, i.e., the occupancy over the PIT capacity, is passed to the
+ * sink every sample period and whenever it crosses a multiple of the configured step,
+ * instead of at every Interest. At every sample the occupancy is resynchronized with the
+ * PIT, to account for the entries erased out of the strategy's sight (e.g., evicted by
+ * the PIT policy, or erased after a failed propagation): it is the number of entries
+ * when every entry costs 1, otherwise the tracked occupancy is scaled to the number of
+ * entries, i.e., the entries gone unnoticed are assumed to have the average cost.
+ */
+class PitTelemetry
+{
+public:
+  typedef Callback<void, double /* usage */, uint32_t /* entries */> UsageCallback;
+
+  PitTelemetry ();
+
+  /**
+   * @brief Reads the PIT capacity and starts sampling
+   * @param pit the PIT of the node
+   * @param nodeId context of the sampling events
+   * @param capacity PIT capacity in the unit of the entry costs, 0 if the PIT is not limited
+   * @param samplePeriod sampling period, 0 to only report the step crossings
+   * @param step the usage is reported every time it crosses a multiple of step, 0 to disable
+   * @param unitCost true when every entry costs 1, i.e., the occupancy is the number of entries
+   */
+  void
+  Start (Ptr<Pit> pit, uint32_t nodeId, double capacity, Time samplePeriod, double step, UsageCallback sink,
+         bool unitCost = true);
+
+  void
+  Stop ();
+
+  /**
+   * @brief Max number of entries of the PIT, 0 if it is not limited
+   */
+  static uint32_t
+  GetMaxSize (Ptr<Pit> pit);
+
+  inline void
+  Add (double cost);
+
+  inline void
+  Remove (double cost);
+
+  /**
+   * @brief Occupancy over capacity, -1 if the PIT size is not limited
+   */
+  double
+  GetUsage () const { return m_capacity == 0 ? -1 : m_occupancy / m_capacity; }
+
+  double
+  GetOccupancy () const { return m_occupancy; }
+
+  uint32_t
+  GetEntries () const { return m_entries; }
+
+private:
+  inline void
+  CheckCrossing ();
+
+  void
+  Sample ();
+
+  void
+  Report ();
+
+private:
+  Ptr<Pit> m_pit;
+  UsageCallback m_sink;
+
+  double m_capacity;
+  bool m_unitCost;
+  double m_occupancy;
+  uint32_t m_entries;
+
+  Time m_samplePeriod;
+  EventId m_sampleEvent;
+  double m_step;
+  int64_t m_lastLevel; // multiple of m_step the last reported usage falls in
+};
+
+inline void
+PitTelemetry::Add (double cost)
+{
+  m_entries++;
+  m_occupancy += cost;
+  CheckCrossing ();
+}
+
+inline void
+PitTelemetry::Remove (double cost)
+{
+  if (m_entries > 0)
+    m_entries--;
+  m_occupancy = (m_occupancy > cost) ? m_occupancy - cost : 0;
+  CheckCrossing ();
+}
+
+inline void
+PitTelemetry::CheckCrossing ()
+{
+  if (m_step <= 0 || m_capacity == 0)
+    return;
+
+  if (static_cast<int64_t> (std::floor (m_occupancy / m_capacity / m_step)) != m_lastLevel)
+    Report ();
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // PIT_TELEMETRY_H
@@ -19,6 +19,7 @@
  */
 
 #include "poseidon.h"
+#include "interest-type.h"
 
 #include "ns3/ndn-l3-protocol.h"
 #include "ns3/ndn-interest.h"
@@ -32,11 +33,15 @@
 #include "ns3/random-variable.h"
 #include "ns3/double.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "hot-path-profiler.h"
 
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lambda/bind.hpp>
+#include <algorithm>
 namespace ll = boost::lambda;
 
 namespace ns3 {
@@ -45,7 +50,7 @@ namespace fw {
 
 NS_OBJECT_ENSURE_REGISTERED (Poseidon);
 // TODOs
-// - check where it is more appropriate to initialize the ResetStats method
+// - check where it is more appropriate to initialize the statistics roll-over
 // in other classes this kind of event happens to be done inside the NotifyNewAggregate
 // while for me it makes more sense inside the class constructor
 
@@ -59,10 +64,22 @@ Poseidon::GetTypeId (void)
     .SetParent <ForwardingStrategy> ()
     .AddConstructor <Poseidon> ()
     .AddTraceSource ("PITUsage",  "PITUsage",  MakeTraceSourceAccessor (&Poseidon::pitUsageTrace))
+    .AddAttribute ("PitSamplePeriod", "Period of the PITUsage samples, 0 to only report the crossings of PitUsageStep",
+      StringValue ("100ms"),
+      MakeTimeAccessor (&Poseidon::m_pitSamplePeriod),
+      MakeTimeChecker ())
+    .AddAttribute ("PitUsageStep", "PITUsage is also reported every time the PIT usage crosses a multiple of this fraction, 0 to disable",
+      StringValue ("0.01"),
+      MakeDoubleAccessor (&Poseidon::m_pitUsageStep),
+      MakeDoubleChecker<double> (0.0))
     .AddAttribute("distributed", "Enable/Disable collaboration among routers",
        BooleanValue(false),
        MakeBooleanAccessor (&Poseidon::m_distributed),
        MakeBooleanChecker ())
+    .AddAttribute("AlertTTL", "Max number of hops a pushback alert is relayed in distributed mode",
+       UintegerValue(3),
+       MakeUintegerAccessor (&Poseidon::m_alertTtl),
+       MakeUintegerChecker<uint8_t> (1))
     .AddAttribute("ScaleFactor", "Factor used to lower omega and rho thresholds",
        StringValue("0.5"),
        MakeDoubleAccessor (&Poseidon::m_scale),
@@ -79,6 +96,10 @@ Poseidon::GetTypeId (void)
        StringValue ("/pushback/alerts"),
        MakeStringAccessor (&Poseidon::CreateAlertsName),
        MakeStringChecker ())
+    .AddAttribute ("AlertBatchPeriod", "Alerts sent out of the same face within a period are batched in one message, 0 to send every alert right away",
+       StringValue ("0s"),
+       MakeTimeAccessor (&Poseidon::m_alertBatchPeriod),
+       MakeTimeChecker ())
     .AddAttribute ("Time Window", "Monitoring interval duration",
       StringValue ("10s"),
       MakeTimeAccessor (&Poseidon::m_timeInterval),
@@ -87,20 +108,144 @@ Poseidon::GetTypeId (void)
       StringValue ("60ms"),
       MakeTimeAccessor (&Poseidon::m_waitTime),
       MakeTimeChecker ())
+    .AddAttribute ("StatsEngine", "How ISR and PIT statistics are kept: reset (default, cleared every time window), sliding (sliding time window) or ewma",
+      StringValue ("reset"),
+      MakeStringAccessor (&Poseidon::SetStatsEngine, &Poseidon::GetStatsEngine),
+      MakeStringChecker ())
+    .AddAttribute ("SubIntervals", "Number of sub-intervals the time window is split in by the sliding and ewma engines",
+      UintegerValue (10),
+      MakeUintegerAccessor (&Poseidon::m_subIntervals),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Detection", "Fired when the detection condition starts holding on a face",
+      MakeTraceSourceAccessor (&Poseidon::m_onDetection))
+    .AddAttribute ("Recovery", "How thresholds are restored after a pushback: none (default), additive or exponential",
+      StringValue ("none"),
+      MakeStringAccessor (&Poseidon::SetRecovery, &Poseidon::GetRecovery),
+      MakeStringChecker ())
+    .AddAttribute ("RecoveryStep", "Additive recovery: fraction of the initial thresholds restored per period",
+      StringValue ("0.1"),
+      MakeDoubleAccessor (&Poseidon::m_recoveryStep),
+      MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("RecoveryFactor", "Exponential recovery: factor the thresholds grow by per period, up to their initial values",
+      StringValue ("2.0"),
+      MakeDoubleAccessor (&Poseidon::m_recoveryFactor),
+      MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("RecoveryPeriod", "Interval between two recovery steps, a face recovers only if it got no alert and its ISR stayed below the initial omega for a whole period",
+      StringValue ("1s"),
+      MakeTimeAccessor (&Poseidon::m_recoveryPeriod),
+      MakeTimeChecker ())
+    .AddTraceSource ("Thresholds", "Per-face omega and rho thresholds, fired every time they change",
+      MakeTraceSourceAccessor (&Poseidon::m_onThresholds))
+    .AddAttribute ("Mitigation", "Reaction to Interests from a detected face within the wait time: drop (default) or shape (per-face token bucket)",
+      StringValue ("drop"),
+      MakeStringAccessor (&Poseidon::SetMitigation, &Poseidon::GetMitigation),
+      MakeStringChecker ())
+    .AddAttribute ("ShapingFactor", "Rate of the token bucket of a detected face, as a multiple of the rate of Data returned to that face",
+      StringValue ("1.0"),
+      MakeDoubleAccessor (&Poseidon::m_shapingFactor),
+      MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinShapingRate", "Minimum rate (Interests per second) of the token bucket of a detected face",
+      StringValue ("1.0"),
+      MakeDoubleAccessor (&Poseidon::m_minShapingRate),
+      MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("BucketDepth", "Max number of tokens of the token bucket of a detected face",
+      StringValue ("10"),
+      MakeDoubleAccessor (&Poseidon::m_bucketDepth),
+      MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("PrefixDetection", "Also require the detection condition to hold for the name prefix of the Interest, so that only the attacked namespace is mitigated",
+      BooleanValue (false),
+      MakeBooleanAccessor (&Poseidon::m_prefixDetection),
+      MakeBooleanChecker ())
+    .AddAttribute ("PrefixDepth", "Number of name components of the prefixes tracked by the prefix detection",
+      UintegerValue (1),
+      MakeUintegerAccessor (&Poseidon::m_prefixDepth),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxPrefixEntries", "Max number of (face, prefix) pairs tracked by the prefix detection, the least recently active ones are evicted",
+      UintegerValue (1024),
+      MakeUintegerAccessor (&Poseidon::m_maxPrefixEntries),
+      MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Propagation", "How Interests are propagated: best (default, first usable FIB face) or balance (spread over the usable FIB faces by outstanding Interests and satisfaction ratio)",
+      StringValue ("best"),
+      MakeStringAccessor (&Poseidon::SetPropagation, &Poseidon::GetPropagation),
+      MakeStringChecker ())
+    .AddTraceSource ("UpstreamLoad", "Balanced propagation: outstanding, sent and satisfied Interests of every upstream face, fired every statistics period",
+      MakeTraceSourceAccessor (&Poseidon::m_onUpstreamLoad))
+    .AddAttribute ("PitAccounting", "Unit of the PIT usage compared against rho and traced by PITUsage: entries (default) or bytes (estimated memory)",
+      StringValue ("entries"),
+      MakeStringAccessor (&Poseidon::SetPitAccounting, &Poseidon::GetPitAccounting),
+      MakeStringChecker ())
+    .AddAttribute ("PitEntryOverhead", "Bytes accounting: estimated bytes of a PIT entry with one nonce, one incoming and one outgoing face record, name excluded",
+      UintegerValue (128),
+      MakeUintegerAccessor (&Poseidon::m_pitEntryOverhead),
+      MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PitNameOverhead", "Bytes accounting: estimated bytes per name component on top of the component value",
+      UintegerValue (16),
+      MakeUintegerAccessor (&Poseidon::m_pitNameOverhead),
+      MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PitRecordOverhead", "Bytes accounting: estimated bytes of every incoming or outgoing face record added to an entry after the first one",
+      UintegerValue (48),
+      MakeUintegerAccessor (&Poseidon::m_pitRecordOverhead),
+      MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PitNonceOverhead", "Bytes accounting: estimated bytes of every nonce added to an entry after the first one",
+      UintegerValue (40),
+      MakeUintegerAccessor (&Poseidon::m_pitNonceOverhead),
+      MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PitMaxBytes", "Bytes accounting: PIT memory rho refers to, 0 to derive it from the PIT MaxSize assuming 64 bytes names",
+      UintegerValue (0),
+      MakeUintegerAccessor (&Poseidon::m_pitMaxBytes),
+      MakeUintegerChecker<uint64_t> ())
+    .AddTraceSource ("PrefixDetection", "Fired when the detection condition starts holding on a (face, prefix) pair",
+      MakeTraceSourceAccessor (&Poseidon::m_onPrefixDetection))
     ;
   return tid;
 }
 
 // Inserting a constructor since I do not see any better place to read the PIT maxSize value
 Poseidon::Poseidon ()
+  : m_pitUsageGauge (0)
+  , m_pitEntriesGauge (0)
+  , m_alertsSent (0)
+  , m_stats (CNT_MAX, MEM_POSEIDON_FACES)
 {  
+  m_stats.SetGauge (CNT_PIT_USAGE);
   m_resetStatsScheduled = false;
   m_virtualPayloadSize = 0;
+  m_subIntervals = 10;
+  m_distributed = false;
+  m_alertTtl = 3;
+  m_recovery = RECOVERY_NONE;
+  m_recoveryStep = 0.1;
+  m_recoveryFactor = 2.0;
+  m_mitigation = MITIGATION_DROP;
+  m_shapingFactor = 1.0;
+  m_minShapingRate = 1.0;
+  m_bucketDepth = 10;
+  m_prefixDetection = false;
+  m_prefixDepth = 1;
+  m_maxPrefixEntries = 1024;
+  m_propagation = PROPAGATION_BEST;
+  m_pitAccounting = PIT_ENTRIES;
+  m_pitEntryOverhead = 128;
+  m_pitNameOverhead = 16;
+  m_pitRecordOverhead = 48;
+  m_pitNonceOverhead = 40;
+  m_pitMaxBytes = 0;
+  m_pitUsageStep = 0.01;
 }
 
 void
 Poseidon::DoDispose ()
 {  
+  for (FaceVector<PendingAlert>::iterator it = m_pendingAlerts.begin (); it != m_pendingAlerts.end (); ++it)
+    it->event.Cancel ();
+  m_pendingAlerts.clear ();
+  m_batchEvent.Cancel ();
+  m_alertBatches.clear ();
+  m_batchedFaces.clear ();
+  m_facePtrs.clear ();
+  m_pitTelemetry.Stop ();
+  m_stats.Stop ();
+
   super::DoDispose ();
 }
 
@@ -117,12 +262,24 @@ Poseidon::NotifyNewAggregate ()
         {
           m_resetStatsScheduled = true;
 
-	  StringValue svPitSize;
-  	  this->m_pit->GetAttribute("MaxSize", svPitSize);
-  	  pitMaxSize = atoi(svPitSize.Get().c_str());
+  	  pitMaxSize = PitTelemetry::GetMaxSize (this->m_pit);
+          MetricLabels labels = MetricsRegistry::NodeLabels (this->template GetObject<Node> ()->GetId ());
+          m_pitUsageGauge = MetricsRegistry::Get ().AddGauge ("pit.usage", labels);
+          m_pitEntriesGauge = MetricsRegistry::Get ().AddGauge ("pit.entries", labels);
+          m_alertsSent = MetricsRegistry::Get ().AddCounter ("poseidon.alerts", labels);
+          m_pitTelemetry.Start (this->m_pit, this->template GetObject<Node> ()->GetId (),
+                                GetPitCapacity (), m_pitSamplePeriod, m_pitUsageStep,
+                                MakeCallback (&Poseidon::ReportPitUsage, this),
+                                m_pitAccounting == PIT_ENTRIES);
+
+          m_prefixStats.Configure (m_prefixDepth, m_maxPrefixEntries);
 
-          Simulator::ScheduleWithContext (this->template GetObject<Node> ()->GetId (),
-                                          m_timeInterval, &Poseidon::ResetStats, this);
+          m_stats.Start (this->template GetObject<Node> ()->GetId (), m_timeInterval, m_subIntervals,
+                         MakeCallback (&Poseidon::OnStatsRoll, this));
+
+          if (m_recovery != RECOVERY_NONE)
+            Simulator::ScheduleWithContext (this->template GetObject<Node> ()->GetId (),
+                                            m_recoveryPeriod, &Poseidon::RecoverThresholds, this);
         }
     }
 }
@@ -145,74 +302,159 @@ Poseidon::AddFace (Ptr<Face> face)
   super::AddFace (face);
 
   NS_LOG_INFO("Setting thresholds on " << face );
-  // Add entries for this face to the stats, times and thresholds maps
-  m_stats[face] = std::make_pair(*(new Isr()),*(new Pur()));
+  // Add an entry for this face to the per-face state, ids are assigned incrementally
+  // so the array only grows by one element at a time
+  if (face->GetId () >= m_faces.size ())
+    {
+      m_faces.resize (face->GetId () + 1);
+      m_facePtrs.resize (face->GetId () + 1);
+      m_pendingAlerts.resize (face->GetId () + 1);
+      m_alertBatches.resize (face->GetId () + 1);
+      m_buckets.resize (face->GetId () + 1);
+      m_outstanding.resize (face->GetId () + 1);
+    }
+  m_facePtrs[face->GetId ()] = face;
+
+  FaceState &state = m_faces[face->GetId ()];
+  state = FaceState ();
+  m_stats.AddFace (face->GetId ());
+  m_outstanding[face->GetId ()] = 0;
 
-  m_thres[face] = std::make_pair(m_omega,m_rho*(double)pitMaxSize);
+  state.omega = m_omega;
+  state.rho = m_rho*GetPitCapacity ();
 
   Time now =  Simulator::Now ();
-  m_times[face] = std::make_pair(now,now);
+  state.lastAlertSent = now;
+  state.lastAlertReceived = now;
+}
+
+void
+Poseidon::RemoveFace (Ptr<Face> face)
+{
+  // ids are never reused, so the slot is just cleared
+  if (face->GetId () < m_faces.size ())
+    {
+      m_faces[face->GetId ()] = FaceState ();
+      m_facePtrs[face->GetId ()] = 0;
+      m_pendingAlerts[face->GetId ()].event.Cancel ();
+      m_alertBatches[face->GetId ()].clear (); // skipped by the next flush
+      m_buckets[face->GetId ()] = TokenBucket ();
+      m_outstanding[face->GetId ()] = 0;
+      m_stats.ClearFace (face->GetId ());
+      m_prefixStats.RemoveFace (face->GetId ());
+    }
 
+  super::RemoveFace (face);
 }
 
 void
 Poseidon::OnInterest (Ptr<Face> face,
                                                Ptr<Interest> interest)
 {
-  // The first thing is to load the stats for this face
-  IsrPurPair *face_stats = &(m_stats.find(face)->second) ;
-  Isr *isr = &(face_stats->first);
-  Pur *pur = &(face_stats->second);
+  NDN_PROFILE_SCOPE ("Poseidon", "OnInterest");
 
-  // then load the threshold values for this face too
-  // for the following you don't need to use refs since you only perform read ops
-  std::pair<double,double> thresholds = m_thres.find(face)->second;
-  double local_omega = thresholds.first;
-  double pit_fraction = thresholds.second;
+  // The first thing is to load the stats and the threshold values for this face
+  FaceState &state = GetFaceState (face);
+  double pit_usage = m_stats.Get (face->GetId (), CNT_PIT_USAGE);
+
+  double local_omega = state.omega;
+  double pit_fraction = state.rho;
   
-  NS_LOG_DEBUG ("ISR " << isr->ratio << " - omega " << local_omega);
-  NS_LOG_DEBUG ("PitEntries " << pur->pitEntries << " - rho*PITsize " << pit_fraction);
-  if(isr->ratio > local_omega && pur->pitEntries > pit_fraction){
-    std::pair<Time,Time> *times = &(m_times.find(face)->second);
-    Time *last_alert = &(times->first); 
+  double isr_ratio = GetIsr (face->GetId ());
+  if (isr_ratio > m_omega)
+    state.isrHigh = true; // no threshold recovery for this period
+  NS_LOG_DEBUG ("ISR " << isr_ratio << " - omega " << local_omega);
+  NS_LOG_DEBUG ("PitUsage " << pit_usage << " - rho*PITsize " << pit_fraction);
+  bool condition = (isr_ratio > local_omega && pit_usage > pit_fraction);
+  CheckDetection (face, state, condition);
+  if (condition && m_prefixDetection)
+    condition = CheckPrefixDetection (face, state, interest);
+  if(condition){
     Time now =  Simulator::Now ();
-    if((now - *last_alert) > m_waitTime){
-       NS_LOG_INFO("Time elapsed since last PushBack was emitted " << (now - *last_alert) );
+    if((now - state.lastAlertSent) > m_waitTime){
+       NS_LOG_INFO("Time elapsed since last PushBack was emitted " << (now - state.lastAlertSent) );
        // if this does not come from an AppFace, issue a pushback; otherwise simply drop
-       if(face->GetInstanceTypeId ().GetName () != "ns3::ndn::AppFace"){
-          GeneratePBalarm (face, m_scale);
-          last_alert = &now;
+       if(!IsAppFace (face)){
+          GeneratePBalarm (face, PushbackAlert (m_scale, isr_ratio, pit_usage, m_alertTtl));
+          state.lastAlertSent = now;
        }
        else
 	  NS_LOG_DEBUG ("Next step is the app, no pushback but drop ");
     }
-    else{
-      // in this case the interest has to be dropped
-      // ideally I would add a specific tracer to keep track of these Interests
-      // assuming the ones written for the parent class cannot be easily leveraged
-
+    else if(m_mitigation == MITIGATION_DROP || !AdmitInterest (face)){
+      // in this case the interest has to be dropped, forwarded ones are
+      // reported by the parent class as any other Interest
       NS_LOG_INFO("Dropping Interest, but no PushBack notification on  " << face );
+      // the parent class never sees this Interest, hence it is reported as received and
+      // dropped here, as the parent does with its own drops, so that the per-face
+      // tracers know the face before its type is reported
+      m_inInterests (interest, face);
+      m_dropInterests (interest, face);
+      interestTypesTrace(GetInterestType (interest), 0);
       return;
     }
   }
 
   // just call the parent class routine to forward this and overload the method DidSendOutInterest to increment our stats counters
   super::OnInterest(face,interest);
-  
-  pitUsageTrace(getPitUsage(), this->m_pit->GetSize());
 }
 
 double
 Poseidon::getPitUsage()
 {
   // If the PIT size is not restricted return -1
-  return pitMaxSize == 0 ? -1 : (double)this->m_pit->GetSize() / (double)pitMaxSize;
+  return m_pitTelemetry.GetUsage ();
+}
+
+void
+Poseidon::ReportPitUsage (double usage, uint32_t entries)
+{
+  pitUsageTrace(usage, entries);
+  m_pitUsageGauge->Set (usage);
+  m_pitEntriesGauge->Set (entries);
+}
+
+// Capacity of the PIT in the accounting unit, rho is a fraction of it
+double
+Poseidon::GetPitCapacity () const
+{
+  if (m_pitAccounting == PIT_ENTRIES)
+    return (double)pitMaxSize;
+
+  if (m_pitMaxBytes != 0)
+    return (double)m_pitMaxBytes;
+
+  return (double)pitMaxSize * (m_pitEntryOverhead + 64);
+}
+
+void
+Poseidon::SetPitAccounting (std::string accounting)
+{
+  if (accounting == "bytes")
+    m_pitAccounting = PIT_BYTES;
+  else
+    {
+      NS_ASSERT_MSG (accounting == "entries", "Unknown PIT accounting " << accounting);
+      m_pitAccounting = PIT_ENTRIES;
+    }
+}
+
+std::string
+Poseidon::GetPitAccounting () const
+{
+  return (m_pitAccounting == PIT_BYTES) ? "bytes" : "entries";
 }
 
 bool
 Poseidon::DoPropagateInterest (Ptr<Face> inFace, Ptr<const Interest> interest, Ptr<pit::Entry> pitEntry)
 {
   NS_LOG_FUNCTION (this << interest->GetName ());
+
+  // the incoming record and the nonce of the Interest are in the entry by now
+  ChargePitRecords (pitEntry, interest);
+
+  if (m_propagation == PROPAGATION_BALANCE)
+    return PropagateBalanced (inFace, interest, pitEntry);
   
   int propagatedCount = 0;
   
@@ -235,6 +477,84 @@ Poseidon::DoPropagateInterest (Ptr<Face> inFace, Ptr<const Interest> interest, P
   return propagatedCount > 0;
 }
 
+// The usable FIB faces (non-red, and accepted by the parent class) are weighted by
+// satisfaction / (1 + outstanding), so that pending Interests, and the PIT state they
+// hold upstream, are spread over the alternatives instead of piling up on the best face.
+// If the picked face refuses the Interest the next pick is done among the remaining ones.
+bool
+Poseidon::PropagateBalanced (Ptr<Face> inFace, Ptr<const Interest> interest, Ptr<pit::Entry> pitEntry)
+{
+  m_candidates.clear ();
+  double total = 0;
+
+  BOOST_FOREACH (const fib::FaceMetric &metricFace, pitEntry->GetFibEntry ()->m_faces.get<fib::i_metric> ())
+    {
+      if (metricFace.GetStatus () == fib::FaceMetric::NDN_FIB_RED) // all non-read faces are in front
+        break;
+
+      // the satisfaction is smoothed so that an upstream never used so far gets a fair chance
+      uint32_t id = metricFace.GetFace ()->GetId ();
+      double satisfaction = (m_stats.Get (id, CNT_UP_SATISFIED) + 1) / (m_stats.Get (id, CNT_UP_SENT) + 1);
+      double weight = satisfaction / (1 + m_outstanding[id]);
+      m_candidates.push_back (std::make_pair (metricFace.GetFace (), weight));
+      total += weight;
+    }
+
+  while (!m_candidates.empty ())
+    {
+      double pick = m_rand.GetValue (0, total);
+      size_t i = 0;
+      while (i < m_candidates.size () - 1 && pick >= m_candidates[i].second)
+        pick -= m_candidates[i++].second;
+
+      NS_LOG_DEBUG ("Trying " << m_candidates[i].first << " weight " << m_candidates[i].second);
+      if (TrySendOutInterest (inFace, m_candidates[i].first, interest, pitEntry))
+        {
+          NS_LOG_INFO ("Propagated to " << m_candidates[i].first);
+          return true;
+        }
+
+      total -= m_candidates[i].second;
+      m_candidates.erase (m_candidates.begin () + i);
+    }
+
+  NS_LOG_INFO ("Propagated to 0 faces");
+  return false;
+}
+
+// Interests sent out of the faces in the entry are no longer pending, the one the
+// Data came from (if any) gets the satisfaction
+void
+Poseidon::ReleaseUpstream (Ptr<pit::Entry> pitEntry, Ptr<const Face> satisfiedBy)
+{
+  BOOST_FOREACH (const pit::OutgoingFace &outgoing, pitEntry->GetOutgoing ())
+    {
+      uint32_t id = outgoing.m_face->GetId ();
+      if (m_outstanding[id] > 0)
+        m_outstanding[id]--;
+      if (outgoing.m_face == satisfiedBy)
+        m_stats.Add (id, CNT_UP_SATISFIED, 1);
+    }
+}
+
+void
+Poseidon::SetPropagation (std::string propagation)
+{
+  if (propagation == "balance")
+    m_propagation = PROPAGATION_BALANCE;
+  else
+    {
+      NS_ASSERT_MSG (propagation == "best", "Unknown propagation " << propagation);
+      m_propagation = PROPAGATION_BEST;
+    }
+}
+
+std::string
+Poseidon::GetPropagation () const
+{
+  return (m_propagation == PROPAGATION_BALANCE) ? "balance" : "best";
+}
+
 void
 Poseidon::DidSendOutInterest (Ptr<Face> inFace,
                                    Ptr<Face> outFace,
@@ -243,15 +563,25 @@ Poseidon::DidSendOutInterest (Ptr<Face> inFace,
 {
   NS_LOG_FUNCTION (inFace);
   super::DidSendOutInterest (inFace, outFace, interest, pitEntry);
+  ChargePitRecords (pitEntry, interest);
+
+  NS_LOG_DEBUG ("Interests " << m_stats.Get (inFace->GetId (), CNT_INTERESTS) << " Contents " << m_stats.Get (inFace->GetId (), CNT_CONTENTS));
+  m_stats.Add (inFace->GetId (), CNT_INTERESTS, 1);
 
-  IsrPurPair *face_stats = &(m_stats.find(inFace)->second) ;
-  Isr *isr = &(face_stats->first);
-  NS_LOG_DEBUG ("Interests " << isr->interestsReceived << " Contents " << isr->contentsReceived);
-  isr->interestsReceived++;
-  double new_ratio = (isr->contentsReceived != 0) ? (isr->interestsReceived/(double) isr->contentsReceived) : 0;
-  isr->ratio = new_ratio;
+  if (m_propagation == PROPAGATION_BALANCE)
+    {
+      // one pending Interest per outgoing record, as ReleaseUpstream releases them: a
+      // retransmission out of the same face only updates the record (retxCount > 0)
+      pit::Entry::out_iterator outgoing = pitEntry->GetOutgoing ().find (outFace);
+      if (outgoing != pitEntry->GetOutgoing ().end () && outgoing->m_retxCount == 0)
+        m_outstanding[outFace->GetId ()]++;
+      m_stats.Add (outFace->GetId (), CNT_UP_SENT, 1);
+    }
 
-  NS_LOG_DEBUG ("New ISR ratio " << new_ratio);
+  if (m_prefixDetection)
+    m_prefixStats.Touch (inFace->GetId (), interest->GetName ()).interests++;
+
+  NS_LOG_DEBUG ("New ISR ratio " << GetIsr (inFace->GetId ()));
 
 }
 
@@ -263,44 +593,425 @@ Poseidon::DidCreatePitEntry (Ptr<Face> inFace,
   NS_LOG_FUNCTION (inFace);
 
   NS_LOG_DEBUG ("Updating PUR stats on " << *inFace);
-  IsrPurPair *face_stats = &(m_stats.find(inFace)->second) ;
-  Pur *pur = &(face_stats->second);
-  pur->pitEntries++;
-  pur->ratio = pur->pitEntries/(double)pitMaxSize;
+  double cost = GetPitCost (pitEntry);
+  m_stats.Add (inFace->GetId (), CNT_PIT_USAGE, cost);
+  m_pitTelemetry.Add (cost);
+  pitEntry->AddFwTag<PitChargeTag> (boost::shared_ptr<PitChargeTag> (new PitChargeTag (inFace->GetId (), cost, interest->GetNonce ())));
+
+  if (m_prefixDetection)
+    m_prefixStats.Touch (inFace->GetId (), interest->GetName ()).pitUsage += cost;
+
+  NS_LOG_DEBUG ("PitUsage " << m_stats.Get (inFace->GetId (), CNT_PIT_USAGE) << " PUR "<< m_stats.Get (inFace->GetId (), CNT_PIT_USAGE)/GetPitCapacity ());
+}
 
-  NS_LOG_DEBUG ("PitEntries " << pur->pitEntries << " PUR "<< pur->ratio);
+// Similar Interests aggregated without being forwarded still add a record and a nonce
+void
+Poseidon::DidSuppressSimilarInterest (Ptr<Face> inFace,
+                                      Ptr<const Interest> interest,
+                                      Ptr<pit::Entry> pitEntry)
+{
+  ChargePitRecords (pitEntry, interest);
+  super::DidSuppressSimilarInterest (inFace, interest, pitEntry);
 }
 
+// Bytes accounting: charges the records added to the entry since the last call, and the
+// nonce of interest if it was not charged yet, to the face and the prefix which paid for
+// the entry and to the whole PIT. Records are only counted up, as ndnSIM only removes
+// them from an entry which is about to be erased
 void
-Poseidon::GeneratePBalarm (Ptr<Face> face, double scale){
+Poseidon::ChargePitRecords (Ptr<pit::Entry> pitEntry, Ptr<const Interest> interest)
+{
+  if (m_pitAccounting == PIT_ENTRIES)
+    return;
+
+  boost::shared_ptr<PitChargeTag> charge = pitEntry->GetFwTag<PitChargeTag> ().lock ();
+  if (charge == 0)
+    return;
+
+  double bytes = 0;
+  uint32_t incoming = pitEntry->GetIncoming ().size ();
+  if (incoming > charge->incoming)
+    {
+      bytes += (incoming - charge->incoming) * m_pitRecordOverhead;
+      charge->incoming = incoming;
+    }
+  uint32_t outgoing = pitEntry->GetOutgoing ().size ();
+  if (outgoing > charge->outgoing)
+    {
+      bytes += (outgoing - charge->outgoing) * m_pitRecordOverhead;
+      charge->outgoing = outgoing;
+    }
+  if (interest->GetNonce () != charge->lastNonce)
+    {
+      bytes += m_pitNonceOverhead;
+      charge->lastNonce = interest->GetNonce ();
+    }
+  if (bytes == 0)
+    return;
+
+  charge->cost += bytes;
+  m_pitTelemetry.Add (bytes);
+  if (charge->faceId < m_stats.GetNFaces ())
+    m_stats.Add (charge->faceId, CNT_PIT_USAGE, bytes);
+  if (m_prefixDetection)
+    {
+      PrefixFaceStats *prefix = m_prefixStats.Find (charge->faceId, pitEntry->GetPrefix ());
+      if (prefix != 0)
+        prefix->pitUsage += bytes;
+    }
+}
+
+// The per-face usage only drops when entries are satisfied (as in the original
+// implementation), while the whole PIT memory follows the entries timing out too
+void
+Poseidon::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry)
+{
+  ReleasePitEntry (pitEntry);
+  if (m_propagation == PROPAGATION_BALANCE)
+    ReleaseUpstream (pitEntry, 0);
+  super::WillEraseTimedOutPendingInterest (pitEntry);
+}
+
+// Gives the amount charged to the entry back to the whole PIT. The charge tag goes with
+// it, so that an entry satisfied and then erased through the timeout path (or the other
+// way round) is released once
+void
+Poseidon::ReleasePitEntry (Ptr<pit::Entry> pitEntry)
+{
+  boost::shared_ptr<PitChargeTag> charge = pitEntry->GetFwTag<PitChargeTag> ().lock ();
+  if (charge == 0)
+    return;
+
+  m_pitTelemetry.Remove (charge->cost);
+  pitEntry->RemoveFwTag<PitChargeTag> ();
+}
+
+// Alerts are batched per face when AlertBatchPeriod is set, so that the reports generated
+// and relayed out of the same face within a period travel in a single message
+void
+Poseidon::GeneratePBalarm (Ptr<Face> face, const PushbackAlert &alert){
 
-  // we cheat a bit at this stage, since we do not send any scale factor back, rather we
-  // assume every router use the same value which is specified so far as class attribute
-  
   NS_LOG_INFO("Emitting PushBack notification on  " << face );
 
-  Ptr<Data> data = Create<Data> (Create<Packet> (m_virtualPayloadSize));
+  if (m_alertBatchPeriod.IsZero ())
+    {
+      SendAlerts (face, FaceVector<PushbackAlert> (1, alert));
+      return;
+    }
+
+  FaceVector<PushbackAlert> &batch = m_alertBatches[face->GetId ()];
+  if (batch.empty ())
+    m_batchedFaces.push_back (face->GetId ());
+  batch.push_back (alert);
+
+  if (!m_batchEvent.IsRunning ())
+    m_batchEvent = Simulator::Schedule (m_alertBatchPeriod, &Poseidon::FlushAlertBatches, this);
+}
+
+void
+Poseidon::FlushAlertBatches ()
+{
+  for (std::vector<uint32_t>::iterator id = m_batchedFaces.begin (); id != m_batchedFaces.end (); ++id)
+    {
+      FaceVector<PushbackAlert> &batch = m_alertBatches[*id];
+      if (m_facePtrs[*id] != 0 && !batch.empty ())
+        SendAlerts (m_facePtrs[*id], batch);
+      batch.clear ();
+    }
+  m_batchedFaces.clear ();
+}
+
+void
+Poseidon::SendAlerts (Ptr<Face> face, const FaceVector<PushbackAlert> &reports)
+{
+  NS_ASSERT (!reports.empty ());
+  NS_LOG_DEBUG ("Sending " << reports.size () << " alert reports on " << face);
+
+  // In local mode we cheat a bit, since we do not send any scale factor back, rather we
+  // assume every router use the same value which is specified so far as class attribute.
+  // In distributed mode the reports travel as payload of the Data
+  // The tag counts the reports on 8 bits. The receiver applies a message as the aggregate
+  // of its reports and refuses the alerts following it within the wait time, so a larger
+  // batch is not split, rather its last reports are aggregated into the 255th one
+  uint8_t nReports = std::min<size_t> (reports.size (), 255);
+  Ptr<Packet> payload;
+  if (m_distributed)
+    {
+      payload = Create<Packet> ();
+      for (uint8_t i = 0; i < nReports - 1; i++)
+        payload->AddHeader (reports[i]);
+
+      PushbackAlert last = reports[nReports - 1];
+      for (size_t i = nReports; i < reports.size (); i++)
+        last.Aggregate (reports[i]);
+      payload->AddHeader (last);
+    }
+  else
+    payload = Create<Packet> (m_virtualPayloadSize);
+
+  // the tag tells the alerts from the regular Data at the receiver
+  payload->AddPacketTag (PushbackAlertTag (nReports));
+
+  Ptr<Data> data = Create<Data> (payload);
   data->SetName (m_alerts_prefix);
   data->SetTimestamp (Simulator::Now ());
   data->SetFreshness (Seconds(0));
   data->SetSignature (12345);
   face->SendData (data);
+  m_alertsSent->Inc (reports.size ());
 
   // Do I need to set any route for those alarms to be forwarded correctly?
 }
 
+// An alert received on inFace means that too many Interests go out of that face. The alert
+// is relayed towards the faces which are contributing to the flood, that is, the ones whose
+// ISR exceeds their own threshold, so that it gets closer to the attackers' ingress routers.
+// Alerts relayed out of the same face are aggregated until its wait time expires.
 void
-Poseidon::ResetStats ()
-{
-  NS_LOG_FUNCTION ("Resetting stats for all faces");
-  PerFaceStats::iterator it;
-  for(it = m_stats.begin(); it != m_stats.end(); ++it){
-    IsrPurPair *face_stats = &(it->second);
-    face_stats->first.Reset();
-    face_stats->second.Reset();
-  }
+Poseidon::RelayAlert (Ptr<Face> inFace, const PushbackAlert &alert)
+{
+  Time now = Simulator::Now ();
+
+  for (uint32_t id = 0; id < m_faces.size (); id++)
+    {
+      Ptr<Face> outFace = m_facePtrs[id];
+      if (outFace == 0 || outFace == inFace || IsAppFace (outFace))
+        continue;
+
+      FaceState &state = m_faces[id];
+      double isr = GetIsr (id);
+      if (isr <= state.omega)
+        continue;
+
+      PushbackAlert relayed (alert.GetScale (), isr, m_stats.Get (id, CNT_PIT_USAGE), alert.GetTtl () - 1);
+
+      PendingAlert &pending = m_pendingAlerts[id];
+      if (pending.event.IsRunning ())
+        {
+          pending.alert.Aggregate (relayed);
+          continue;
+        }
+
+      pending.alert = relayed;
+      Time wait = state.lastAlertSent + m_waitTime - now;
+      if (wait.IsNegative ())
+        wait = Seconds (0);
+
+      NS_LOG_INFO("Relaying PushBack notification on " << outFace << " in " << wait.ToDouble (Time::S) << "s");
+      pending.event = Simulator::Schedule (wait, &Poseidon::FlushRelay, this, id);
+    }
+}
+
+void
+Poseidon::FlushRelay (uint32_t faceId)
+{
+  if (m_facePtrs[faceId] == 0)
+    return;
+
+  GeneratePBalarm (m_facePtrs[faceId], m_pendingAlerts[faceId].alert);
+  m_faces[faceId].lastAlertSent = Simulator::Now ();
+}
+
+bool
+Poseidon::IsAppFace (Ptr<const Face> face) const
+{
+  return face->GetInstanceTypeId ().GetName () == "ns3::ndn::AppFace";
+}
+
+// Called by the statistics engine at every roll-over, before the counters are cleared
+// or decayed. The strategy state which is not kept in the FaceStats decays along with
+// the counters
+void
+Poseidon::OnStatsRoll ()
+{
+  // the upstream counters are reported at every period, the outstanding Interests
+  // are a level and are left untouched
+  if (m_propagation == PROPAGATION_BALANCE)
+    {
+      for (uint32_t id = 0; id < m_outstanding.size (); id++)
+        {
+          if (m_facePtrs[id] == 0 || (m_stats.Get (id, CNT_UP_SENT) == 0 && m_outstanding[id] == 0))
+            continue;
+
+          m_onUpstreamLoad (m_facePtrs[id], m_outstanding[id],
+                            m_stats.Get (id, CNT_UP_SENT), m_stats.Get (id, CNT_UP_SATISFIED));
+        }
+    }
+
+  // the prefix statistics are not kept per sub-interval, so they decay as in the
+  // ewma engine also when the sliding one is used
+  if (m_prefixDetection)
+    m_prefixStats.Decay (m_stats.GetDecay ());
+}
 
-  Simulator::Schedule (m_timeInterval, &Poseidon::ResetStats, this);
+void
+Poseidon::SetStatsEngine (std::string engine)
+{
+  m_stats.SetEngine (engine);
+}
+
+std::string
+Poseidon::GetStatsEngine () const
+{
+  return m_stats.GetEngine ();
+}
+
+void
+Poseidon::SetRecovery (std::string recovery)
+{
+  if (recovery == "additive")
+    m_recovery = RECOVERY_ADDITIVE;
+  else if (recovery == "exponential")
+    m_recovery = RECOVERY_EXPONENTIAL;
+  else
+    {
+      NS_ASSERT_MSG (recovery == "none", "Unknown threshold recovery " << recovery);
+      m_recovery = RECOVERY_NONE;
+    }
+}
+
+std::string
+Poseidon::GetRecovery () const
+{
+  switch (m_recovery)
+    {
+    case RECOVERY_ADDITIVE:
+      return "additive";
+    case RECOVERY_EXPONENTIAL:
+      return "exponential";
+    default:
+      return "none";
+    }
+}
+
+// Thresholds lowered by pushbacks are brought back towards their initial values once
+// the face has been quiet for a whole recovery period: no alert received and the ISR
+// below the initial omega at every Interest received (isrHigh) and at the tick
+void
+Poseidon::RecoverThresholds ()
+{
+  Time now = Simulator::Now ();
+  double initial_omega = m_omega;
+  double initial_rho = m_rho*GetPitCapacity ();
+
+  for (uint32_t id = 0; id < m_faces.size (); id++)
+    {
+      FaceState &state = m_faces[id];
+      bool isrHigh = state.isrHigh || GetIsr (id) > initial_omega;
+      state.isrHigh = false; // next period
+      if (m_facePtrs[id] == 0 || (state.omega >= initial_omega && state.rho >= initial_rho))
+        continue;
+
+      if ((now - state.lastAlertReceived) < m_recoveryPeriod || isrHigh)
+        continue;
+
+      if (m_recovery == RECOVERY_ADDITIVE)
+        {
+          state.omega += m_recoveryStep * initial_omega;
+          state.rho += m_recoveryStep * initial_rho;
+        }
+      else
+        {
+          state.omega *= m_recoveryFactor;
+          state.rho *= m_recoveryFactor;
+        }
+
+      state.omega = std::min (state.omega, initial_omega);
+      state.rho = std::min (state.rho, initial_rho);
+
+      NS_LOG_DEBUG ("Thresholds restored on " << m_facePtrs[id] << " omega " << state.omega << " rho " << state.rho);
+      m_onThresholds (m_facePtrs[id], state.omega, state.rho);
+    }
+
+  Simulator::Schedule (m_recoveryPeriod, &Poseidon::RecoverThresholds, this);
+}
+
+// The bucket is refilled lazily at each Interest, its rate follows the current Data rate
+// of the face so that the admitted Interests track what the face actually gets back
+bool
+Poseidon::AdmitInterest (Ptr<const Face> face)
+{
+  TokenBucket &bucket = m_buckets[face->GetId ()];
+  Time now = Simulator::Now ();
+
+  bucket.rate = std::max (m_minShapingRate, m_shapingFactor * GetDataRate (face->GetId ()));
+  bucket.tokens = std::min (m_bucketDepth,
+                            bucket.tokens + bucket.rate * (now - bucket.lastRefill).ToDouble (Time::S));
+  bucket.lastRefill = now;
+
+  NS_LOG_DEBUG ("Bucket on " << face << " rate " << bucket.rate << " tokens " << bucket.tokens);
+  if (bucket.tokens < 1.0)
+    return false;
+
+  bucket.tokens -= 1.0;
+  return true;
+}
+
+// Rate of Data returned to a face over the statistics window. With the reset engine
+// the counter only covers the time elapsed since the last reset
+double
+Poseidon::GetDataRate (uint32_t faceId) const
+{
+  double window = m_stats.GetElapsed ();
+  return (window > 0) ? m_stats.Get (faceId, CNT_CONTENTS) / window : 0;
+}
+
+void
+Poseidon::SetMitigation (std::string mitigation)
+{
+  if (mitigation == "shape")
+    m_mitigation = MITIGATION_SHAPE;
+  else
+    {
+      NS_ASSERT_MSG (mitigation == "drop", "Unknown mitigation " << mitigation);
+      m_mitigation = MITIGATION_DROP;
+    }
+}
+
+std::string
+Poseidon::GetMitigation () const
+{
+  return (m_mitigation == MITIGATION_SHAPE) ? "shape" : "drop";
+}
+
+// With the prefix detection on, a detected face is only mitigated for the prefixes whose
+// own statistics exceed the face thresholds, so that the legitimate namespaces served
+// through the same face keep flowing. Prefixes which are not tracked are never mitigated.
+bool
+Poseidon::CheckPrefixDetection (Ptr<const Face> face, const FaceState &state, Ptr<const Interest> interest)
+{
+  PrefixFaceStats *prefix = m_prefixStats.Find (face->GetId (), interest->GetName ());
+  if (prefix == 0)
+    return false;
+
+  bool condition = (prefix->Ratio () > state.omega && prefix->pitUsage > state.rho);
+  NS_LOG_DEBUG ("Prefix ISR " << prefix->Ratio () << " PitEntries " << prefix->pitUsage << " condition " << condition);
+
+  if (condition && !prefix->detected)
+    m_onPrefixDetection (face, m_prefixStats.GetPrefix (interest->GetName ()), prefix->Ratio (), prefix->pitUsage);
+  prefix->detected = condition;
+
+  return condition;
+}
+
+// The detection trace is only fired on the transitions of the condition, so the
+// reaction time to an attack is the time of the first detection after its onset
+void
+Poseidon::CheckDetection (Ptr<const Face> face, FaceState &state, bool condition)
+{
+  if (condition && !state.detected)
+    {
+      NS_LOG_INFO ("Detection on " << face << " at " << Simulator::Now ().ToDouble (Time::S) << "s");
+      m_onDetection (face, GetIsr (face->GetId ()), m_stats.Get (face->GetId (), CNT_PIT_USAGE));
+
+      // a newly detected face starts with a full bucket
+      if (m_mitigation == MITIGATION_SHAPE)
+        {
+          m_buckets[face->GetId ()].tokens = m_bucketDepth;
+          m_buckets[face->GetId ()].lastRefill = Simulator::Now ();
+        }
+    }
+  state.detected = condition;
 }
 
 void
@@ -311,25 +1022,45 @@ Poseidon::OnData (Ptr<Face> face, Ptr<Data> data)
   // it is important to understand when to update statistics, I'd say whenever
   // a PIT entry is satisfied, so in the SatisfyPendingInterest (inFace, data, pitEntry);
 
-  Name data_name = data->GetName ();
-
-  if(data_name.compare(*m_alerts_prefix) == 0){
+  // alerts are told from the regular Data by their tag rather than by name
+  PushbackAlertTag alertTag;
+  if(data->GetPayload ()->PeekPacketTag (alertTag)){
 
     NS_LOG_INFO("Received Pushback notification on  " << face );
-    std::pair<Time,Time> *times = &(m_times.find(face)->second);
-    Time *last_alert_received = &(times->second);
+    FaceState &state = GetFaceState (face);
     Time now = Simulator::Now ();
 
-    if ((now - *last_alert_received) > m_waitTime){
+    if ((now - state.lastAlertReceived) > m_waitTime){
 
        NS_LOG_INFO("Pushback processed for " << face );
+       // in distributed mode the scale factor comes with the alert, otherwise the local one is used
+       // a batch is applied as a single alert with the strongest of its reports
+       PushbackAlert alert (m_scale, 0, 0, 0);
+       if (m_distributed)
+         {
+           Ptr<Packet> payload = data->GetPayload ()->Copy ();
+           PushbackAlert report;
+           for (uint8_t i = 0; i < alertTag.GetReports () && payload->GetSize () >= report.GetSerializedSize (); i++)
+             {
+               payload->RemoveHeader (report);
+               NS_LOG_DEBUG ("Alert " << report);
+               if (i == 0)
+                 alert = report;
+               else
+                 alert.Aggregate (report);
+             }
+         }
+
        // sufficient time has elapsed since the last alert
        // so this can be accepted and thresholds should be lowered down 
-       std::pair<double,double> *thresholds = &(m_thres.find(face)->second);
-       thresholds->first*=m_scale;
-       thresholds->second*=m_scale;
+       state.omega*=alert.GetScale ();
+       state.rho*=alert.GetScale ();
+       m_onThresholds (face, state.omega, state.rho);
 
-       last_alert_received = &now;
+       state.lastAlertReceived = now;
+
+       if (m_distributed && alert.GetTtl () > 1)
+         RelayAlert (face, alert);
 
     }
     else{
@@ -347,11 +1078,12 @@ Poseidon::OnData (Ptr<Face> face, Ptr<Data> data)
 }
 
 // This function is really critical, since the Face where you get the Data is not the same
-// as the one you got the interest. This means that the lookup on the m_stats must be done 
-// by using a reference to the face.
+// as the one you got the interest. This means that the lookup on the m_faces must be done 
+// by using the faces recorded as incoming in the PIT entry.
 void
 Poseidon::SatisfyPendingInterest (Ptr<Face> inFace,Ptr<const Data> data,Ptr<pit::Entry> pitEntry)
 {
+  NDN_PROFILE_SCOPE ("Poseidon", "SatisfyPendingInterest");
 
   NS_LOG_FUNCTION (inFace << data->GetName ());
 
@@ -359,26 +1091,41 @@ Poseidon::SatisfyPendingInterest (Ptr<Face> inFace,Ptr<const Data> data,Ptr<pit:
   {
       NS_LOG_DEBUG ("Updating stats on " << *incoming.m_face);
   
-      IsrPurPair *face_stats = &(m_stats.find(incoming.m_face)->second);
-      Isr *isr = &(face_stats->first);
-      NS_LOG_DEBUG ("Interests " << isr->interestsReceived << " Contents " << isr->contentsReceived);
-      isr->contentsReceived++;
-      double new_ratio = (isr->contentsReceived != 0) ? (isr->interestsReceived/(double) isr->contentsReceived) : 0;
-      isr->ratio = new_ratio;
-      
-      Pur *pur = &(face_stats->second);
-      NS_LOG_DEBUG ("PitEntries " << pur->pitEntries << " Ratio " << pur->ratio);
-      
-      //NS_ASSERT_MSG((pur->pitEntries != 0 ), "PitEntries cannot be decremented when is zero");
-      if(pur->pitEntries != 0)
-	pur->pitEntries--;
-
-      pur->ratio = pur->pitEntries/(double) pitMaxSize;
-  
+      uint32_t id = incoming.m_face->GetId ();
+      NS_LOG_DEBUG ("Interests " << m_stats.Get (id, CNT_INTERESTS) << " Contents " << m_stats.Get (id, CNT_CONTENTS));
+      m_stats.Add (id, CNT_CONTENTS, 1);
+
+      if (m_prefixDetection)
+        {
+          // the pair may have been evicted meanwhile, in that case there is nothing to update
+          PrefixFaceStats *prefix = m_prefixStats.Find (incoming.m_face->GetId (), data->GetName ());
+          if (prefix != 0)
+            prefix->contents++;
+        }
   }
 
+  // the PIT usage is only given back to the face which was charged when the entry was
+  // created, the other incoming faces never paid for it
+  boost::shared_ptr<PitChargeTag> charge = pitEntry->GetFwTag<PitChargeTag> ().lock ();
+  if (charge != 0 && charge->faceId < m_stats.GetNFaces ())
+    {
+      double pit_usage = m_stats.Get (charge->faceId, CNT_PIT_USAGE);
+      NS_LOG_DEBUG ("PitUsage " << pit_usage << " Ratio " << pit_usage/GetPitCapacity ());
+      m_stats.Add (charge->faceId, CNT_PIT_USAGE, -std::min (pit_usage, charge->cost));
+
+      if (m_prefixDetection)
+        {
+          PrefixFaceStats *prefix = m_prefixStats.Find (charge->faceId, data->GetName ());
+          if (prefix != 0)
+            prefix->pitUsage = std::max (0.0, prefix->pitUsage - charge->cost);
+        }
+    }
+
   // I call this as last operation, since it includes clearing PIT entries content
   // and I don't want to risk to access sth here which has already been cleared there
+  ReleasePitEntry (pitEntry);
+  if (m_propagation == PROPAGATION_BALANCE)
+    ReleaseUpstream (pitEntry, inFace);
   super::SatisfyPendingInterest(inFace, data, pitEntry);
 
   // SMALL MEMO for the future.
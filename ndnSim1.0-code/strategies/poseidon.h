@@ -21,53 +21,122 @@
 #include "ndn-forwarding-strategy.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "ns3/ndn-name.h"
+#include "ns3/ndn-pit-entry.h"
+#include "ns3/ndnSIM/model/fw/ndn-fw-tag.h"
 #include "ns3/traced-callback.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable.h"
+#include "pushback-alert.h"
+#include "pushback-alert-tag.h"
+#include "prefix-stats-trie.h"
+#include "pit-telemetry.h"
+#include "face-stats.h"
+#include "metrics-registry.h"
+#include "memory-accounting.h"
+#include <boost/static_assert.hpp>
 #include <map> 
+#include <vector>
 #include <utility>
 
 namespace ns3 {
 namespace ndn {
 namespace fw {
 
-typedef struct Isr {
-      uint32_t interestsReceived;
-      uint32_t contentsReceived;
-      double ratio;
-
-      Isr():interestsReceived(0),contentsReceived(0),ratio(0.00){}
-
-      void Reset(){
-	interestsReceived = contentsReceived = 0;
-      	ratio = 0.00;
-      }
-
-    } Isr;
-
-// The poseidon's paper talks about the pit size in MB taken by traffic coming from
-// each interface. Our workaround simply counts the entries and divides those 
-// by the max pit Size
-typedef struct Pur {
-      uint32_t pitEntries;
-      double ratio;
-
-      Pur():pitEntries(0),ratio(0){}
-
-      void Reset(){
-	pitEntries = 0;
-	ratio = 0;
-      }
-
-    } Pur;
-
-typedef std::pair<Isr, Pur>  IsrPurPair;
-typedef std::map<Ptr<Face>, IsrPurPair> PerFaceStats;
-typedef std::map<Ptr<Face>, std::pair<double,double>> PerFaceThresholds;
-// Let's associate two timers at each interface. The first one relates to
-// the alarms sent through that interface, while the second relates to the
-// ones received.
-typedef std::map<Ptr<Face>, std::pair<Time,Time>> PerFaceTimes;
-
+// The per-face statistics (Interests received, Data returned and PIT usage) are kept
+// in the shared FaceStats engine. The poseidon's paper talks about the pit size in MB
+// taken by traffic coming from each interface. By default our workaround simply counts
+// the entries and divides those by the max pit Size, with the bytes accounting the usage
+// is the estimated memory taken by the entries (see PitAccounting)
+
+// All the rest of the per-face state in one place: thresholds and the two alert
+// timers (the first one relates to the alarms sent through that interface, while
+// the second relates to the ones received).
+typedef struct FaceState {
+      bool detected; // true while the detection condition holds on this face
+      bool isrHigh; // the ISR went above the initial omega during the current recovery period
+      double omega; // current threshold for the ISR
+      double rho;   // current threshold for the PIT usage
+      Time lastAlertSent;
+      Time lastAlertReceived;
+
+      FaceState():detected(false),isrHigh(false),omega(0),rho(0){}
+
+    } FaceState;
+
+// FaceState and the counters of a face in the FaceStats are each read on every packet,
+// keep each of them within the size of a cache line
+BOOST_STATIC_ASSERT (sizeof (FaceState) <= 64);
+
+// Per-face token bucket used by the shaping mitigation. It is kept out of FaceState
+// since it is only touched for the faces on which the detection condition holds
+typedef struct TokenBucket {
+      double tokens;
+      double rate; // tokens per second, derived from the Data returned to the face
+      Time lastRefill;
+
+      TokenBucket():tokens(0),rate(0){}
+
+    } TokenBucket;
+
+// Reaction to the Interests received on a face while the detection condition holds
+// and no alert can be sent (i.e., inside the wait time):
+//  - drop: all of them are dropped (original behavior)
+//  - shape: they are admitted by a per-face token bucket whose rate follows the
+//    rate of Data returned to that face, the excess is dropped
+enum Mitigation { MITIGATION_DROP, MITIGATION_SHAPE };
+
+// Threshold recovery after a pushback: thresholds are either never restored (original
+// behavior), increased by a fixed step or multiplied by a factor, up to their initial values
+enum ThresholdRecovery { RECOVERY_NONE, RECOVERY_ADDITIVE, RECOVERY_EXPONENTIAL };
+
+// How Interests are propagated upstream:
+//  - best: first usable face in the FIB order (original behavior)
+//  - balance: one usable face picked at random, weighted by its satisfaction ratio
+//    and inversely to its outstanding Interests
+enum Propagation { PROPAGATION_BEST, PROPAGATION_BALANCE };
+
+// Unit of the PIT usage compared against rho and reported by the PITUsage trace
+enum PitAccounting { PIT_ENTRIES, PIT_BYTES };
+
+// Indexes of the Poseidon counters in the FaceStats: Interests received, Data returned
+// and PIT usage of the Interests received on a face, then Interests sent out of a face
+// and satisfied by it (balanced propagation)
+enum StatsCounter { CNT_INTERESTS = 0, CNT_CONTENTS, CNT_PIT_USAGE, CNT_UP_SENT, CNT_UP_SATISFIED, CNT_MAX };
+
+BOOST_STATIC_ASSERT (CNT_MAX * sizeof (double) <= 64);
+
+// Per-face vectors, accounted as MEM_POSEIDON_FACES
+template<class T>
+using FaceVector = std::vector<T, AccountingAllocator<T, MEM_POSEIDON_FACES> >;
+
+// Faces are indexed by their id, which the L3 protocol assigns incrementally
+typedef FaceVector<FaceState> PerFaceState;
+
+// Distributed mode: alerts to be relayed out of a face are aggregated until the
+// wait time of that face expires
+typedef struct PendingAlert {
+      PushbackAlert alert;
+      EventId event;
+    } PendingAlert;
+
+// Face charged with the PIT usage of an entry and the amount charged so far, kept on the
+// entry so that the same face is debited by the same amount when the entry is satisfied,
+// however many faces the entry aggregates by then. In bytes mode the charge grows with
+// the face records and nonces added after the creation, which are counted here. The tag
+// is removed when the entry is released, so an entry is never released twice
+struct PitChargeTag : public fw::Tag
+{
+  PitChargeTag (uint32_t _faceId, double _cost, uint32_t _nonce)
+    : faceId (_faceId), cost (_cost), incoming (1), outgoing (1), lastNonce (_nonce) { }
+
+  uint32_t faceId;
+  double cost;
+  uint32_t incoming; // face records charged, the first ones come with the entry
+  uint32_t outgoing;
+  uint32_t lastNonce; // nonce of the last Interest charged
+};
 
 class Poseidon : public ForwardingStrategy
 {
@@ -97,13 +166,103 @@ public:
 
   virtual void
   AddFace (Ptr<Face> face);
+
+  virtual void
+  RemoveFace (Ptr<Face> face);
   
 private:
+  inline FaceState &
+  GetFaceState (Ptr<const Face> face);
+
+  void
+  GeneratePBalarm (Ptr<Face> face, const PushbackAlert &alert);
+
+  void
+  RelayAlert (Ptr<Face> inFace, const PushbackAlert &alert);
+
+  void
+  FlushRelay (uint32_t faceId);
+
+  void
+  SendAlerts (Ptr<Face> face, const FaceVector<PushbackAlert> &reports);
+
+  void
+  FlushAlertBatches ();
+
+  bool
+  IsAppFace (Ptr<const Face> face) const;
+
+  void
+  OnStatsRoll ();
+
+  inline double
+  GetIsr (uint32_t faceId) const;
+
+  void
+  SetStatsEngine (std::string engine);
+
+  std::string
+  GetStatsEngine () const;
+
+  void
+  CheckDetection (Ptr<const Face> face, FaceState &state, bool condition);
+
+  bool
+  CheckPrefixDetection (Ptr<const Face> face, const FaceState &state, Ptr<const Interest> interest);
+
+  void
+  RecoverThresholds ();
+
+  bool
+  AdmitInterest (Ptr<const Face> face);
+
+  double
+  GetDataRate (uint32_t faceId) const;
+
+  inline double
+  GetPitCost (Ptr<const pit::Entry> pitEntry) const;
+
+  double
+  GetPitCapacity () const;
+
+  bool
+  PropagateBalanced (Ptr<Face> inFace, Ptr<const Interest> interest, Ptr<pit::Entry> pitEntry);
+
+  void
+  ReleaseUpstream (Ptr<pit::Entry> pitEntry, Ptr<const Face> satisfiedBy);
+
+  void
+  SetPropagation (std::string propagation);
+
+  std::string
+  GetPropagation () const;
+
   void
-  GeneratePBalarm (Ptr<Face> face, double scale);
+  ChargePitRecords (Ptr<pit::Entry> pitEntry, Ptr<const Interest> interest);
 
   void
-  ResetStats ();
+  ReleasePitEntry (Ptr<pit::Entry> pitEntry);
+
+  void
+  ReportPitUsage (double usage, uint32_t entries);
+
+  void
+  SetPitAccounting (std::string accounting);
+
+  std::string
+  GetPitAccounting () const;
+
+  void
+  SetMitigation (std::string mitigation);
+
+  std::string
+  GetMitigation () const;
+
+  void
+  SetRecovery (std::string recovery);
+
+  std::string
+  GetRecovery () const;
 
   void
   InitThresholds();
@@ -138,11 +297,23 @@ protected:
                      Ptr<const Interest> interest,
                      Ptr<pit::Entry> pitEntry);
 
+  virtual void
+  DidSuppressSimilarInterest (Ptr<Face> inFace,
+                              Ptr<const Interest> interest,
+                              Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry);
+
   virtual void
   DoDispose ();
     
 
   TracedCallback<double, uint32_t> pitUsageTrace; // this is needed for the PIT tracer
+  // PIT usage and alerts in the MetricsRegistry, registered along with the PIT telemetry
+  MetricGauge *m_pitUsageGauge;
+  MetricGauge *m_pitEntriesGauge;
+  MetricCounter *m_alertsSent;
 private:
   static LogComponent g_log;
   
@@ -152,9 +323,17 @@ private:
 
   Ptr<Name> m_alerts_prefix; // reserved name space used to transmit the pushback alerts
 
-  PerFaceStats m_stats; // this is meant to track ISR and PUR values which are compared with the tresholds omega and rho at each Interest reception
-  PerFaceThresholds m_thres; 
-  PerFaceTimes m_times;
+  PerFaceState m_faces; // this is meant to track ISR and PUR values which are compared with the per-face tresholds omega and rho at each Interest reception
+  FaceVector<Ptr<Face> > m_facePtrs; // faces by id, only used out of the Interest path (e.g., to relay alerts)
+  FaceVector<PendingAlert> m_pendingAlerts;
+  uint32_t m_alertTtl; // max number of hops an alert travels in distributed mode
+  Time m_alertBatchPeriod; // alerts for the same face within a period travel in one message, 0 to send them right away
+  FaceVector<FaceVector<PushbackAlert> > m_alertBatches; // reports waiting for the next flush, by face id
+  std::vector<uint32_t> m_batchedFaces; // faces with a non-empty batch
+  EventId m_batchEvent;
+
+  FaceStats m_stats; // CNT_MAX counters per face
+  uint32_t m_subIntervals; // number of sub-intervals of the time window, used by the sliding and ewma engines
 
   double m_omega; // threshold for the ISR-like metric
   double m_rho; // threshold for the PIT usage
@@ -163,13 +342,77 @@ private:
   Time m_timeInterval; // time window during which statistics must be counted
   Time m_waitTime; // minimum notifications inter-gap
 
+  ThresholdRecovery m_recovery;
+  double m_recoveryStep; // additive: fraction of the initial thresholds restored per period
+  double m_recoveryFactor; // exponential: growth factor per period, greater than 1
+  Time m_recoveryPeriod; // thresholds are restored every period on faces with no alert and normal ISR
+
+  Mitigation m_mitigation;
+  FaceVector<TokenBucket> m_buckets; // shaping mitigation, indexed by face id
+  double m_shapingFactor; // bucket rate as a multiple of the Data rate returned to the face
+  double m_minShapingRate; // floor of the bucket rate, so that a face with no Data is not cut off
+  double m_bucketDepth; // max number of tokens (burst) of a bucket
+
+  bool m_prefixDetection; // when on, the detection condition must also hold for the name prefix of the Interest
+  uint32_t m_prefixDepth; // number of name components of the tracked prefixes
+  uint32_t m_maxPrefixEntries; // max number of (face, prefix) pairs tracked by the trie
+  PrefixStatsTrie m_prefixStats;
+
   int pitMaxSize;
+
+  Propagation m_propagation;
+  FaceVector<double> m_outstanding; // balanced propagation, Interests pending per upstream face
+  std::vector<std::pair<Ptr<Face>, double> > m_candidates; // scratch space of the balanced propagation
+  UniformVariable m_rand;
+
+  PitAccounting m_pitAccounting;
+  uint32_t m_pitEntryOverhead; // bytes of an entry with one nonce, one incoming and one outgoing record, name excluded
+  uint32_t m_pitNameOverhead; // bytes per name component on top of its value
+  uint32_t m_pitRecordOverhead; // bytes of every further incoming or outgoing record
+  uint32_t m_pitNonceOverhead; // bytes of every further nonce
+  uint64_t m_pitMaxBytes; // PIT memory, 0 to derive it from the max PIT size
+  PitTelemetry m_pitTelemetry; // occupancy of the whole PIT, in the accounting unit
+  Time m_pitSamplePeriod;
+  double m_pitUsageStep;
   uint32_t m_virtualPayloadSize; // payload of the pushback data alert
 
   TracedCallback< Ptr<const Face>, double /* ratio */, double/* adjusted weight */, double /* limit */ > m_onLimitsAnnounce;
+  TracedCallback< Ptr<const Face>, double /* isr */, double /* pit usage */ > m_onDetection;
+  TracedCallback< Ptr<const Face>, double /* omega */, double /* rho */ > m_onThresholds;
+  TracedCallback< Ptr<const Face>, double /* outstanding */, double /* sent */, double /* satisfied */ > m_onUpstreamLoad;
+  TracedCallback< Ptr<const Face>, const Name & /* prefix */, double /* isr */, double /* pit usage */ > m_onPrefixDetection;
 };
 
 
+inline double
+Poseidon::GetIsr (uint32_t faceId) const
+{
+  return m_stats.Ratio (faceId, CNT_INTERESTS, CNT_CONTENTS);
+}
+
+// Estimated memory of a new entry: the fixed part plus the name, which is where long
+// titles and short fake suffixes differ. The records and nonces added later are
+// charged by ChargePitRecords
+inline double
+Poseidon::GetPitCost (Ptr<const pit::Entry> pitEntry) const
+{
+  if (m_pitAccounting == PIT_ENTRIES)
+    return 1;
+
+  const Name &name = pitEntry->GetPrefix ();
+  double bytes = m_pitEntryOverhead;
+  for (size_t i = 0; i < name.size (); i++)
+    bytes += name.get (i).size () + m_pitNameOverhead;
+  return bytes;
+}
+
+inline FaceState &
+Poseidon::GetFaceState (Ptr<const Face> face)
+{
+  NS_ASSERT_MSG (face->GetId () < m_faces.size (), "Face " << face->GetId () << " was never added to Poseidon");
+  return m_faces[face->GetId ()];
+}
+
 } // namespace fw
 } // namespace ndn
 } // namespace ns3
@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "prefix-stats-trie.h"
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+PrefixStatsTrie::PrefixStatsTrie ()
+  : m_root (0, "")
+  , m_depth (1)
+  , m_maxEntries (1024)
+  , m_evictions (0)
+{
+}
+
+PrefixStatsTrie::~PrefixStatsTrie ()
+{
+  Clear (&m_root);
+}
+
+void
+PrefixStatsTrie::Configure (uint32_t depth, uint32_t maxEntries)
+{
+  NS_ASSERT_MSG (maxEntries > 0, "The prefix trie must hold at least one entry");
+
+  // statistics collected with a different depth are meaningless, start over
+  if (depth != m_depth)
+    {
+      Clear (&m_root);
+      m_lru.clear ();
+    }
+
+  m_depth = depth;
+  m_maxEntries = maxEntries;
+
+  while (m_lru.size () > m_maxEntries)
+    {
+      Erase (--m_lru.end ());
+      m_evictions++;
+    }
+}
+
+PrefixStatsTrie::Node *
+PrefixStatsTrie::Lookup (const Name &name, bool create)
+{
+  Node *node = &m_root;
+  for (size_t i = 0; i < m_depth && i < name.size (); i++)
+    {
+      std::string component = name.get (i).toBlob ();
+      ChildMap::iterator child = node->children.find (component);
+      if (child == node->children.end ())
+        {
+          if (!create)
+            return 0;
+          child = node->children.insert (std::make_pair (component, new Node (node, component))).first;
+        }
+      node = child->second;
+    }
+  return node;
+}
+
+PrefixFaceStats &
+PrefixStatsTrie::Touch (uint32_t faceId, const Name &name)
+{
+  PrefixFaceStats *stats = Find (faceId, name);
+  if (stats != 0)
+    return *stats;
+
+  // evict before walking down the trie, since pruning the victim's branch may
+  // remove nodes of the path to the new entry
+  if (m_lru.size () >= m_maxEntries)
+    {
+      Erase (--m_lru.end ());
+      m_evictions++;
+    }
+
+  Node *leaf = Lookup (name, true);
+  m_lru.push_front (Entry (faceId, leaf));
+  leaf->entries[faceId] = m_lru.begin ();
+  return m_lru.front ().stats;
+}
+
+PrefixFaceStats *
+PrefixStatsTrie::Find (uint32_t faceId, const Name &name)
+{
+  Node *leaf = Lookup (name, false);
+  if (leaf == 0)
+    return 0;
+
+  EntryMap::iterator found = leaf->entries.find (faceId);
+  if (found == leaf->entries.end ())
+    return 0;
+
+  m_lru.splice (m_lru.begin (), m_lru, found->second);
+  return &found->second->stats;
+}
+
+void
+PrefixStatsTrie::Decay (double factor)
+{
+  for (EntryList::iterator it = m_lru.begin (); it != m_lru.end (); ++it)
+    {
+      it->stats.interests *= factor;
+      it->stats.contents *= factor;
+      // the PIT usage is a level, only cleared with the reset engine (factor 0)
+      if (factor == 0)
+        it->stats.pitUsage = 0;
+    }
+}
+
+void
+PrefixStatsTrie::RemoveFace (uint32_t faceId)
+{
+  EntryList::iterator it = m_lru.begin ();
+  while (it != m_lru.end ())
+    {
+      EntryList::iterator entry = it++;
+      if (entry->stats.faceId == faceId)
+        Erase (entry);
+    }
+}
+
+Name
+PrefixStatsTrie::GetPrefix (const Name &name) const
+{
+  Name prefix;
+  for (size_t i = 0; i < m_depth && i < name.size (); i++)
+    prefix.append (name.get (i).toBlob ());
+  return prefix;
+}
+
+void
+PrefixStatsTrie::Erase (EntryList::iterator entry)
+{
+  Node *leaf = entry->leaf;
+  leaf->entries.erase (entry->stats.faceId);
+  m_lru.erase (entry);
+  Prune (leaf);
+}
+
+// removes the branch ending in node as long as it holds neither entries nor children
+void
+PrefixStatsTrie::Prune (Node *node)
+{
+  while (node != &m_root && node->entries.empty () && node->children.empty ())
+    {
+      Node *parent = node->parent;
+      parent->children.erase (node->component);
+      delete node;
+      node = parent;
+    }
+}
+
+void
+PrefixStatsTrie::Clear (Node *node)
+{
+  for (ChildMap::iterator it = node->children.begin (); it != node->children.end (); ++it)
+    {
+      Clear (it->second);
+      delete it->second;
+    }
+  node->children.clear ();
+  node->entries.clear ();
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef PREFIX_STATS_TRIE_H
+#define PREFIX_STATS_TRIE_H
+
+#include "ns3/ndn-name.h"
+
+#include "memory-accounting.h"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <string>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+// Poseidon statistics of the Interests for one name prefix received on one face
+typedef struct PrefixFaceStats {
+      uint32_t faceId;
+      double interests;
+      double contents;
+      double pitUsage;
+      bool detected; // true while the detection condition holds for this (face, prefix)
+
+      PrefixFaceStats(uint32_t id):faceId(id),interests(0),contents(0),pitUsage(0),detected(false){}
+
+      // unlike the per-face ISR, a prefix getting no Data back is the typical flooded
+      // namespace, so the ratio is not zeroed when no content has been received
+      double Ratio() const{
+        return interests/((contents > 1) ? contents : 1);
+      }
+
+    } PrefixFaceStats;
+
+/**
+ * @brief Bounded-memory trie of per (face, name prefix) statistics
+ *
+ * Names are truncated to their first 'depth' components, each trie leaf holds the
+ * statistics of the faces that prefix was requested from. At most 'maxEntries'
+ * (face, prefix) pairs are kept: when a new pair does not fit, the least recently
+ * active one is evicted and the trie branches left empty are removed.
+ *
+ * Nodes, entries and the maps of the trie are accounted as MEM_POSEIDON_PREFIXES.
+ */
+class PrefixStatsTrie
+{
+public:
+  PrefixStatsTrie ();
+
+  ~PrefixStatsTrie ();
+
+  void
+  Configure (uint32_t depth, uint32_t maxEntries);
+
+  /**
+   * @brief Returns the statistics of (faceId, prefix of name), creating them if needed
+   */
+  PrefixFaceStats &
+  Touch (uint32_t faceId, const Name &name);
+
+  /**
+   * @brief Returns the statistics of (faceId, prefix of name), or 0 if they are not tracked
+   */
+  PrefixFaceStats *
+  Find (uint32_t faceId, const Name &name);
+
+  /**
+   * @brief Scales the Interests and Data counters by factor, the PIT usage is a level
+   * and is only cleared, with factor 0
+   */
+  void
+  Decay (double factor);
+
+  void
+  RemoveFace (uint32_t faceId);
+
+  Name
+  GetPrefix (const Name &name) const;
+
+  size_t
+  GetSize () const { return m_lru.size (); }
+
+  uint64_t
+  GetEvictions () const { return m_evictions; }
+
+private:
+  struct Node;
+
+  typedef struct Entry {
+      PrefixFaceStats stats;
+      Node *leaf;
+
+      Entry(uint32_t faceId, Node *node):stats(faceId),leaf(node){}
+
+    } Entry;
+
+  typedef std::list<Entry, AccountingAllocator<Entry, MEM_POSEIDON_PREFIXES> > EntryList; // most recently active first
+
+  typedef std::map<std::string, Node *, std::less<std::string>,
+                   AccountingAllocator<std::pair<const std::string, Node *>, MEM_POSEIDON_PREFIXES> > ChildMap;
+  typedef std::map<uint32_t, EntryList::iterator, std::less<uint32_t>,
+                   AccountingAllocator<std::pair<const uint32_t, EntryList::iterator>, MEM_POSEIDON_PREFIXES> > EntryMap;
+
+  // the component is held twice, by the node and as the key of its parent's map
+  struct Node {
+      Node *parent;
+      std::string component;
+      ChildMap children;
+      EntryMap entries; // leaves only, by face id
+
+      Node(Node *p, const std::string &c):parent(p),component(c){
+        MemoryAccounting::Allocate (MEM_POSEIDON_PREFIXES, 2 * MemoryAccounting::StringBytes (component));
+      }
+
+      ~Node(){
+        MemoryAccounting::Deallocate (MEM_POSEIDON_PREFIXES, 2 * MemoryAccounting::StringBytes (component));
+      }
+
+      static void *
+      operator new (std::size_t size)
+      {
+        MemoryAccounting::Allocate (MEM_POSEIDON_PREFIXES, size);
+        return ::operator new (size);
+      }
+
+      static void
+      operator delete (void *p, std::size_t size)
+      {
+        MemoryAccounting::Deallocate (MEM_POSEIDON_PREFIXES, size);
+        ::operator delete (p);
+      }
+
+    private:
+      // the children are owned, a copy would delete them twice
+      Node(Node const&);
+      Node& operator=(Node const&);
+    };
+
+  Node *
+  Lookup (const Name &name, bool create);
+
+  void
+  Erase (EntryList::iterator entry);
+
+  void
+  Prune (Node *node);
+
+  void
+  Clear (Node *node);
+
+  PrefixStatsTrie (const PrefixStatsTrie &);
+
+  PrefixStatsTrie &
+  operator = (const PrefixStatsTrie &);
+
+private:
+  Node m_root;
+  EntryList m_lru;
+  uint32_t m_depth;
+  uint32_t m_maxEntries;
+  uint64_t m_evictions;
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // PREFIX_STATS_TRIE_H
@@ -0,0 +1,72 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "pushback-alert-tag.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+NS_OBJECT_ENSURE_REGISTERED (PushbackAlertTag);
+
+TypeId
+PushbackAlertTag::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::fw::PushbackAlertTag")
+    .SetGroupName ("Ndn")
+    .SetParent<Tag> ()
+    .AddConstructor<PushbackAlertTag> ()
+    ;
+  return tid;
+}
+
+TypeId
+PushbackAlertTag::GetInstanceTypeId () const
+{
+  return PushbackAlertTag::GetTypeId ();
+}
+
+uint32_t
+PushbackAlertTag::GetSerializedSize () const
+{
+  return sizeof (uint8_t);
+}
+
+void
+PushbackAlertTag::Serialize (TagBuffer i) const
+{
+  i.WriteU8 (m_reports);
+}
+
+void
+PushbackAlertTag::Deserialize (TagBuffer i)
+{
+  m_reports = i.ReadU8 ();
+}
+
+void
+PushbackAlertTag::Print (std::ostream &os) const
+{
+  os << "reports=" << (uint32_t) m_reports;
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,73 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef PUSHBACK_ALERT_TAG_H
+#define PUSHBACK_ALERT_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+/**
+ * @brief Marks the Data packets carrying Poseidon pushback alerts
+ *
+ * Routers tell the alerts from the regular Data by this tag, instead of comparing
+ * the name of every Data with the alerts name space. The tag also carries the number
+ * of PushbackAlert reports batched in the payload (distributed mode).
+ */
+class PushbackAlertTag : public Tag
+{
+public:
+  static TypeId
+  GetTypeId (void);
+
+  PushbackAlertTag () : m_reports (1) { }
+
+  PushbackAlertTag (uint8_t reports) : m_reports (reports) { }
+
+  uint8_t
+  GetReports () const { return m_reports; }
+
+  virtual TypeId
+  GetInstanceTypeId () const;
+
+  virtual uint32_t
+  GetSerializedSize () const;
+
+  virtual void
+  Serialize (TagBuffer i) const;
+
+  virtual void
+  Deserialize (TagBuffer i);
+
+  virtual void
+  Print (std::ostream &os) const;
+
+private:
+  uint8_t m_reports;
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // PUSHBACK_ALERT_TAG_H
@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "pushback-alert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+NS_OBJECT_ENSURE_REGISTERED (PushbackAlert);
+
+// doubles are written bit by bit in network order
+static inline void
+WriteDouble (Buffer::Iterator &i, double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  i.WriteHtonU64 (bits);
+}
+
+static inline double
+ReadDouble (Buffer::Iterator &i)
+{
+  uint64_t bits = i.ReadNtohU64 ();
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+PushbackAlert::PushbackAlert ()
+  : m_scale (1.0)
+  , m_isr (0)
+  , m_pitEntries (0)
+  , m_ttl (0)
+{
+}
+
+PushbackAlert::PushbackAlert (double scale, double isr, double pitEntries, uint8_t ttl)
+  : m_scale (scale)
+  , m_isr (isr)
+  , m_pitEntries (pitEntries)
+  , m_ttl (ttl)
+{
+}
+
+TypeId
+PushbackAlert::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::fw::PushbackAlert")
+    .SetGroupName ("Ndn")
+    .SetParent<Header> ()
+    .AddConstructor<PushbackAlert> ()
+    ;
+  return tid;
+}
+
+TypeId
+PushbackAlert::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PushbackAlert::GetSerializedSize () const
+{
+  return 3 * sizeof (uint64_t) + sizeof (uint8_t);
+}
+
+void
+PushbackAlert::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  WriteDouble (i, m_scale);
+  WriteDouble (i, m_isr);
+  WriteDouble (i, m_pitEntries);
+  i.WriteU8 (m_ttl);
+}
+
+uint32_t
+PushbackAlert::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_scale = ReadDouble (i);
+  m_isr = ReadDouble (i);
+  m_pitEntries = ReadDouble (i);
+  m_ttl = i.ReadU8 ();
+  return GetSerializedSize ();
+}
+
+void
+PushbackAlert::Print (std::ostream &os) const
+{
+  os << "scale=" << m_scale << " isr=" << m_isr << " pitEntries=" << m_pitEntries << " ttl=" << (uint32_t) m_ttl;
+}
+
+void
+PushbackAlert::Aggregate (const PushbackAlert &other)
+{
+  m_scale = std::min (m_scale, other.m_scale);
+  m_isr = std::max (m_isr, other.m_isr);
+  m_pitEntries = std::max (m_pitEntries, other.m_pitEntries);
+  m_ttl = std::max (m_ttl, other.m_ttl);
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2011-2013 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef PUSHBACK_ALERT_H
+#define PUSHBACK_ALERT_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+/**
+ * @brief Payload of the Poseidon pushback alerts in distributed mode
+ *
+ * The alert carries the scale factor the receiver has to apply to its thresholds,
+ * the ISR and PIT entries measured on the offending face by the sender and a
+ * time-to-live, i.e., how many more hops the alert may be relayed towards the
+ * ingress of the attack.
+ */
+class PushbackAlert : public Header
+{
+public:
+  PushbackAlert ();
+
+  PushbackAlert (double scale, double isr, double pitEntries, uint8_t ttl);
+
+  static TypeId
+  GetTypeId ();
+
+  virtual TypeId
+  GetInstanceTypeId () const;
+
+  virtual uint32_t
+  GetSerializedSize () const;
+
+  virtual void
+  Serialize (Buffer::Iterator start) const;
+
+  virtual uint32_t
+  Deserialize (Buffer::Iterator start);
+
+  virtual void
+  Print (std::ostream &os) const;
+
+  double
+  GetScale () const { return m_scale; }
+
+  double
+  GetIsr () const { return m_isr; }
+
+  double
+  GetPitEntries () const { return m_pitEntries; }
+
+  uint8_t
+  GetTtl () const { return m_ttl; }
+
+  /**
+   * @brief Merges another alert into this one, keeping the strongest scale factor,
+   * the worst statistics and the longest time-to-live
+   */
+  void
+  Aggregate (const PushbackAlert &other);
+
+private:
+  double m_scale;
+  double m_isr;
+  double m_pitEntries;
+  uint8_t m_ttl;
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // PUSHBACK_ALERT_H
@@ -0,0 +1,337 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ *         Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "satisfaction-based-pushback.h"
+
+#include "ns3/ndn-l3-protocol.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-data.h"
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-pit-entry.h"
+#include "ns3/ndnSIM/utils/ndn-limits.h"
+#include "ns3/ndnSIM/utils/ndn-fw-hop-count-tag.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/random-variable.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+template<class Parent>
+LogComponent SatisfactionBasedPushback<Parent>::g_log = LogComponent (SatisfactionBasedPushback<Parent>::GetLogName ().c_str ());
+
+template<class Parent>
+std::string
+SatisfactionBasedPushback<Parent>::GetLogName ()
+{
+  return super::GetLogName ()+".SatisfactionBasedPushback";
+}
+
+template<class Parent>
+TypeId
+SatisfactionBasedPushback<Parent>::GetTypeId (void)
+{
+  static TypeId tid = TypeId ((super::GetTypeId ().GetName ()+"::SatisfactionBasedPushback").c_str ())
+    .SetGroupName ("Ndn")
+    .template SetParent <super> ()
+    .template AddConstructor <SatisfactionBasedPushback<Parent> > ()
+    .template AddTraceSource ("PITUsage",  "PITUsage",  MakeTraceSourceAccessor (&SatisfactionBasedPushback<Parent>::pitUsageTrace))
+    .template AddAttribute ("GraceThreshold", "Fraction of resources that we are willing to sacrifice for \"bad traffic\"",
+                            DoubleValue (0.05),
+                            MakeDoubleAccessor (&SatisfactionBasedPushback::m_graceThreshold),
+                            MakeDoubleChecker<double> (0.0, 1.0))
+
+    .template AddAttribute ("StatsEngine", "How the satisfaction statistics are kept: reset, sliding or ewma (default). Limits are announced at every roll-over",
+                            StringValue ("ewma"),
+                            MakeStringAccessor (&SatisfactionBasedPushback::SetStatsEngine, &SatisfactionBasedPushback::GetStatsEngine),
+                            MakeStringChecker ())
+    .template AddAttribute ("TimeWindow", "Time window of the satisfaction statistics",
+                            StringValue ("10s"),
+                            MakeTimeAccessor (&SatisfactionBasedPushback::m_timeInterval),
+                            MakeTimeChecker ())
+    .template AddAttribute ("SubIntervals", "Number of sub-intervals the time window is split in by the sliding and ewma engines",
+                            UintegerValue (10),
+                            MakeUintegerAccessor (&SatisfactionBasedPushback::m_subIntervals),
+                            MakeUintegerChecker<uint32_t> (1))
+
+    .template AddAttribute ("PitSamplePeriod", "Period of the PITUsage samples, 0 to only report the crossings of PitUsageStep",
+                            StringValue ("100ms"),
+                            MakeTimeAccessor (&SatisfactionBasedPushback::m_pitSamplePeriod),
+                            MakeTimeChecker ())
+    .template AddAttribute ("PitUsageStep", "PITUsage is also reported every time the PIT usage crosses a multiple of this fraction, 0 to disable",
+                            DoubleValue (0.01),
+                            MakeDoubleAccessor (&SatisfactionBasedPushback::m_pitUsageStep),
+                            MakeDoubleChecker<double> (0.0))
+
+    .AddTraceSource ("LimitsAnnounce", "Fired when limits are announced on a face",
+                     MakeTraceSourceAccessor (&SatisfactionBasedPushback::m_onLimitsAnnounce))
+    ;
+  return tid;
+}
+
+template<class Parent>
+SatisfactionBasedPushback<Parent>::SatisfactionBasedPushback ()
+  : m_announceEventScheduled (false)
+  , m_graceThreshold (0.05)
+  , m_stats (CNT_MAX)
+  , m_subIntervals (10)
+  , m_pitUsageStep (0.01)
+{
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::DoDispose ()
+{
+  m_stats.Stop ();
+  m_pitTelemetry.Stop ();
+  m_facePtrs.clear ();
+
+  super::DoDispose ();
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::NotifyNewAggregate ()
+{
+  super::NotifyNewAggregate ();
+
+  if (!m_announceEventScheduled)
+    {
+      if (this->m_pit != 0 && this->m_fib != 0 && this->template GetObject<Node> () != 0)
+        {
+          m_announceEventScheduled = true;
+          uint32_t nodeId = this->template GetObject<Node> ()->GetId ();
+
+          m_pitTelemetry.Start (this->m_pit, nodeId, PitTelemetry::GetMaxSize (this->m_pit),
+                                m_pitSamplePeriod, m_pitUsageStep,
+                                MakeCallback (&SatisfactionBasedPushback<Parent>::ReportPitUsage, this));
+
+          // limits are announced at every roll-over, from the statistics of the window which ends
+          m_stats.Start (nodeId, m_timeInterval, m_subIntervals,
+                         MakeCallback (&SatisfactionBasedPushback<Parent>::AnnounceLimits, this));
+        }
+    }
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::AddFace (Ptr<Face> face)
+{
+  super::AddFace (face);
+
+  if (face->GetId () >= m_facePtrs.size ())
+    m_facePtrs.resize (face->GetId () + 1);
+  m_facePtrs[face->GetId ()] = face;
+  m_stats.AddFace (face->GetId ());
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::RemoveFace (Ptr<Face> face)
+{
+  if (face->GetId () < m_facePtrs.size ())
+    {
+      m_facePtrs[face->GetId ()] = 0;
+      m_stats.ClearFace (face->GetId ());
+    }
+
+  super::RemoveFace (face);
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::OnInterest (Ptr<Face> face,
+                                               Ptr<Interest> interest)
+{
+  if (interest->GetScope () != 0)
+    super::OnInterest (face, interest);
+  else
+    ApplyAnnouncedLimit (face, interest);
+}
+
+template<class Parent>
+double
+SatisfactionBasedPushback<Parent>::getPitUsage()
+{
+  // If the PIT size is not restricted return -1
+  return m_pitTelemetry.GetUsage ();
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::ReportPitUsage (double usage, uint32_t entries)
+{
+  pitUsageTrace (usage, entries);
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::DidCreatePitEntry (Ptr<Face> inFace,
+                                                      Ptr<const Interest> interest,
+                                                      Ptr<pit::Entry> pitEntry)
+{
+  super::DidCreatePitEntry (inFace, interest, pitEntry);
+  m_pitTelemetry.Add (1);
+  pitEntry->AddFwTag<PendingEntryTag> (boost::shared_ptr<PendingEntryTag> (new PendingEntryTag ()));
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::WillSatisfyPendingInterest (Ptr<Face> inFace,
+                                                               Ptr<pit::Entry> pitEntry)
+{
+  if (!pitEntry->GetFwTag<PendingEntryTag> ().expired ())
+    {
+      BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
+        {
+          m_stats.Add (incoming.m_face->GetId (), CNT_SATISFIED, 1);
+        }
+      m_pitTelemetry.Remove (1);
+      pitEntry->RemoveFwTag<PendingEntryTag> ();
+    }
+
+  super::WillSatisfyPendingInterest (inFace, pitEntry);
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry)
+{
+  if (!pitEntry->GetFwTag<PendingEntryTag> ().expired ())
+    {
+      BOOST_FOREACH (const pit::IncomingFace &incoming, pitEntry->GetIncoming ())
+        {
+          m_stats.Add (incoming.m_face->GetId (), CNT_UNSATISFIED, 1);
+        }
+      m_pitTelemetry.Remove (1);
+      pitEntry->RemoveFwTag<PendingEntryTag> ();
+    }
+
+  super::WillEraseTimedOutPendingInterest (pitEntry);
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::AnnounceLimits ()
+{
+  // faces with no statistics yet get the benefit of the doubt
+  double sumOfWeights = 0;
+  for (uint32_t id = 0; id < m_facePtrs.size (); id++)
+    {
+      if (m_facePtrs[id] == 0 || m_facePtrs[id]->template GetObject<Limits> () == 0)
+        continue;
+
+      double total = m_stats.Get (id, CNT_SATISFIED) + m_stats.Get (id, CNT_UNSATISFIED);
+      sumOfWeights += (total > 0) ? m_stats.Get (id, CNT_SATISFIED) / total : 1.0;
+    }
+
+  double weightNormalization = (sumOfWeights >= 1) ? 1.0 / sumOfWeights : 1.0;
+
+  for (uint32_t id = 0; id < m_facePtrs.size (); id++)
+    {
+      Ptr<Face> inFace = m_facePtrs[id];
+      if (inFace == 0)
+        continue;
+
+      Ptr<Limits> faceLimits = inFace->template GetObject<Limits> ();
+      if (faceLimits == 0)
+        continue; // e.g., application faces
+
+      double total = m_stats.Get (id, CNT_SATISFIED) + m_stats.Get (id, CNT_UNSATISFIED);
+      double ratio = (total > 0) ? m_stats.Get (id, CNT_SATISFIED) / total : 1.0;
+      double weight = std::max (m_graceThreshold, ratio * weightNormalization);
+      double limit = faceLimits->GetMaxLimit () * weight;
+
+      m_onLimitsAnnounce (inFace, ratio, weight, limit);
+
+      Ptr<Interest> announceInterest = Create<Interest> ();
+      announceInterest->SetScope (0); // link-local
+
+      Ptr<Name> prefixWithLimit = Create<Name> ("/limit");
+      prefixWithLimit->append (boost::lexical_cast<std::string> (limit));
+      announceInterest->SetName (prefixWithLimit);
+
+      FwHopCountTag hopCountTag;
+      announceInterest->GetPayload ()->AddPacketTag (hopCountTag);
+
+      inFace->SendInterest (announceInterest);
+    }
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::ApplyAnnouncedLimit (Ptr<Face> inFace,
+                                                        Ptr<const Interest> interest)
+{
+  Ptr<Limits> faceLimits = inFace->template GetObject<Limits> ();
+  if (faceLimits == 0)
+    return;
+
+  double limit = boost::lexical_cast<double> (interest->GetName ().get (-1).toBlob ());
+  NS_LOG_DEBUG ("Limit announced on " << inFace << ": " << limit);
+  faceLimits->UpdateCurrentLimit (limit);
+}
+
+template<class Parent>
+void
+SatisfactionBasedPushback<Parent>::SetStatsEngine (std::string engine)
+{
+  m_stats.SetEngine (engine);
+}
+
+template<class Parent>
+std::string
+SatisfactionBasedPushback<Parent>::GetStatsEngine () const
+{
+  return m_stats.GetEngine ();
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#include <ns3/ndnSIM/model/fw/best-route.h>
+#include <ns3/ndnSIM/model/fw/per-out-face-limits.h>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+template class SatisfactionBasedPushback< PerOutFaceLimits<BestRoute> >;
+typedef SatisfactionBasedPushback< PerOutFaceLimits<BestRoute> > SatisfactionBasedPushbackPerOutFaceLimitsBestRoute;
+NS_OBJECT_ENSURE_REGISTERED (SatisfactionBasedPushbackPerOutFaceLimitsBestRoute);
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
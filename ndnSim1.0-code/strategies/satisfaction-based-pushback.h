@@ -0,0 +1,158 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ *         Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef NDNSIM_SATISFACTION_BASED_PUSHBACK_H
+#define NDNSIM_SATISFACTION_BASED_PUSHBACK_H
+
+#include <ns3/event-id.h>
+#include "ns3/traced-callback.h"
+#include "ns3/ndn-forwarding-strategy.h"
+#include "ns3/ndnSIM/model/fw/ndn-fw-tag.h"
+
+#include "face-stats.h"
+#include "pit-telemetry.h"
+
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+// Marks the PIT entries counted in the PitTelemetry and not yet accounted as satisfied
+// or unsatisfied, so that an entry satisfied and then erased through the timeout path
+// leaves the statistics once
+struct PendingEntryTag : public fw::Tag
+{
+};
+
+/**
+ * \ingroup ndn-fw
+ * \brief Satisfaction-based pushback
+ *
+ * Every announcement period the router computes, for each incoming face, the ratio of
+ * the Interests received on it which have been satisfied, and announces to the
+ * downstream on that face the Interest rate it is allowed to send, i.e., a share of the
+ * face capacity proportional to the ratio (never lower than the grace threshold).
+ * Announcements are link-local Interests /limit/<rate>, the downstream applies them to
+ * the Limits of its outgoing face.
+ *
+ * Ported from the ndnSIM-ddos-interest-flooding code base, the per-face satisfied and
+ * unsatisfied counters are kept in the shared FaceStats engine, whose roll-over paces
+ * the announcements, and the PIT usage comes from the shared PitTelemetry.
+ */
+template<class Parent>
+class SatisfactionBasedPushback :
+    public Parent
+{
+private:
+  typedef Parent super;
+
+public:
+  static TypeId
+  GetTypeId ();
+
+  /**
+   * @brief Default constructor
+   */
+  SatisfactionBasedPushback ();
+
+  static std::string
+  GetLogName ();
+
+  double getPitUsage();
+  
+  virtual void
+  OnInterest (Ptr<Face> face,
+              Ptr<Interest> interest);
+
+  virtual void
+  AddFace (Ptr<Face> face);
+
+  virtual void
+  RemoveFace (Ptr<Face> face);
+
+  virtual void
+  WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry);
+
+protected:
+  // from Object
+  virtual void
+  NotifyNewAggregate (); ///< @brief Even when object is aggregated to another Object
+
+  virtual void
+  DoDispose ();
+
+  virtual void
+  DidCreatePitEntry (Ptr<Face> inFace,
+                     Ptr<const Interest> interest,
+                     Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  WillSatisfyPendingInterest (Ptr<Face> inFace,
+                              Ptr<pit::Entry> pitEntry);
+
+  TracedCallback<double, uint32_t> pitUsageTrace;
+private:
+  void
+  AnnounceLimits ();
+
+  void
+  ApplyAnnouncedLimit (Ptr<Face> inFace,
+                       Ptr<const Interest> interest);
+
+  void
+  ReportPitUsage (double usage, uint32_t entries);
+
+  void
+  SetStatsEngine (std::string engine);
+
+  std::string
+  GetStatsEngine () const;
+
+private:
+  static LogComponent g_log;
+
+  // Indexes of the SBP counters in the FaceStats: Interests received on a face which
+  // have been satisfied and which have timed out
+  enum { CNT_SATISFIED = 0, CNT_UNSATISFIED, CNT_MAX };
+
+  bool m_announceEventScheduled;
+
+  double m_graceThreshold;
+
+  FaceStats m_stats;
+  Time m_timeInterval;
+  uint32_t m_subIntervals;
+  std::vector<Ptr<Face> > m_facePtrs; // faces by id
+
+  PitTelemetry m_pitTelemetry;
+  Time m_pitSamplePeriod;
+  double m_pitUsageStep;
+
+  TracedCallback< Ptr<const Face>, double /* ratio */, double/* adjusted weight */, double /* limit */ > m_onLimitsAnnounce;
+};
+
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDNSIM_SATISFACTION_BASED_PUSHBACK_H
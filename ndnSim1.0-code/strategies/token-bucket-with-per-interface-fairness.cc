@@ -0,0 +1,276 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ *         Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#include "token-bucket-with-per-interface-fairness.h"
+
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-pit-entry.h"
+#include "ns3/ndnSIM/utils/ndn-limits.h"
+#include "interest-type.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+
+#include <boost/foreach.hpp>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+template<class Parent>
+LogComponent TokenBucketWithPerInterfaceFairness<Parent>::g_log = LogComponent (TokenBucketWithPerInterfaceFairness<Parent>::GetLogName ().c_str ());
+
+template<class Parent>
+std::string
+TokenBucketWithPerInterfaceFairness<Parent>::GetLogName ()
+{
+  return super::GetLogName ()+".TokenBucketWithPerInterfaceFairness";
+}
+
+template<class Parent>
+TypeId
+TokenBucketWithPerInterfaceFairness<Parent>::GetTypeId (void)
+{
+  static TypeId tid = TypeId ((super::GetTypeId ().GetName ()+"::TokenBucketWithPerInterfaceFairness").c_str ())
+    .SetGroupName ("Ndn")
+    .template SetParent <super> ()
+    .template AddConstructor <TokenBucketWithPerInterfaceFairness<Parent> > ()
+
+    .template AddAttribute ("MaxQueueSize", "Max number of Interests queued for an outgoing face per incoming face",
+                            UintegerValue (100),
+                            MakeUintegerAccessor (&TokenBucketWithPerInterfaceFairness<Parent>::m_maxQueueSize),
+                            MakeUintegerChecker<uint32_t> ())
+    ;
+  return tid;
+}
+
+template<class Parent>
+TokenBucketWithPerInterfaceFairness<Parent>::TokenBucketWithPerInterfaceFairness ()
+  : m_maxQueueSize (100)
+{
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::DoDispose ()
+{
+  m_queues.clear ();
+  m_facePtrs.clear ();
+
+  super::DoDispose ();
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::AddFace (Ptr<Face> face)
+{
+  super::AddFace (face);
+
+  uint32_t id = face->GetId ();
+  if (id >= m_facePtrs.size ())
+    {
+      m_facePtrs.resize (id + 1);
+      m_queues.resize (id + 1);
+    }
+  m_facePtrs[id] = face;
+
+  Ptr<Limits> limits = face->template GetObject<Limits> ();
+  if (limits != 0)
+    limits->RegisterAvailableSlotCallback (MakeCallback (&TokenBucketWithPerInterfaceFairness<Parent>::ProcessFromQueue, this));
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::RemoveFace (Ptr<Face> face)
+{
+  uint32_t id = face->GetId ();
+  if (id < m_facePtrs.size ())
+    {
+      // the queued tags of the entries go away with them
+      m_facePtrs[id] = 0;
+      m_queues[id] = OutQueue ();
+      BOOST_FOREACH (OutQueue &queue, m_queues)
+        {
+          if (id < queue.perInFace.size ())
+            {
+              queue.size -= queue.perInFace[id].size ();
+              queue.perInFace[id].clear ();
+            }
+        }
+    }
+
+  super::RemoveFace (face);
+}
+
+template<class Parent>
+bool
+TokenBucketWithPerInterfaceFairness<Parent>::TrySendOutInterest (Ptr<Face> inFace,
+                                                                 Ptr<Face> outFace,
+                                                                 Ptr<const Interest> interest,
+                                                                 Ptr<pit::Entry> pitEntry)
+{
+  NS_LOG_FUNCTION (this << inFace << outFace << pitEntry->GetPrefix ());
+
+  Ptr<Limits> limits = outFace->template GetObject<Limits> ();
+  uint32_t outId = outFace->GetId ();
+  if (limits == 0 || outId >= m_queues.size ())
+    return super::TrySendOutInterest (inFace, outFace, interest, pitEntry);
+
+  if (pitEntry->GetOutgoing ().find (outFace) != pitEntry->GetOutgoing ().end ())
+    return false; // already sent out there
+
+  OutQueue &queue = m_queues[outId];
+  if (queue.size == 0 && limits->IsBelowLimit ())
+    return super::TrySendOutInterest (inFace, outFace, interest, pitEntry);
+
+  uint32_t inId = inFace->GetId ();
+  if (inId >= queue.perInFace.size ())
+    queue.perInFace.resize (inId + 1);
+
+  if (queue.perInFace[inId].size () >= m_maxQueueSize)
+    {
+      NS_LOG_DEBUG ("Queue of " << *inFace << " towards " << *outFace << " is full, dropping");
+      this->interestTypesTrace (GetInterestType (interest), 0);
+      return false;
+    }
+
+  boost::shared_ptr<QueuedTag> queued = pitEntry->GetFwTag<QueuedTag> ().lock ();
+  if (queued == 0)
+    {
+      queued = boost::shared_ptr<QueuedTag> (new QueuedTag ());
+      pitEntry->AddFwTag<QueuedTag> (queued);
+    }
+  queued->count++;
+
+  queue.perInFace[inId].push_back (pitEntry);
+  queue.size++;
+  return true;
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::ProcessFromQueue ()
+{
+  // slots are made available by any of the Limits, try all the faces with a backlog
+  for (uint32_t outId = 0; outId < m_queues.size (); outId++)
+    {
+      if (m_queues[outId].size == 0 || m_facePtrs[outId] == 0)
+        continue;
+
+      Ptr<Limits> limits = m_facePtrs[outId]->template GetObject<Limits> ();
+      while (m_queues[outId].size > 0 && limits->IsBelowLimit ())
+        {
+          if (!SendFromQueue (outId))
+            break;
+        }
+    }
+}
+
+template<class Parent>
+bool
+TokenBucketWithPerInterfaceFairness<Parent>::SendFromQueue (uint32_t outId)
+{
+  OutQueue &queue = m_queues[outId];
+  uint32_t nInFaces = queue.perInFace.size ();
+
+  for (uint32_t i = 0; i < nInFaces; i++)
+    {
+      uint32_t inId = (queue.next + i) % nInFaces;
+      std::deque< Ptr<pit::Entry> > &fifo = queue.perInFace[inId];
+      if (fifo.empty ())
+        continue;
+
+      Ptr<pit::Entry> pitEntry = fifo.front ();
+      fifo.pop_front ();
+      queue.size--;
+      queue.next = (inId + 1) % nInFaces;
+
+      boost::shared_ptr<QueuedTag> queued = pitEntry->GetFwTag<QueuedTag> ().lock ();
+      if (queued == 0)
+        return true; // satisfied or timed out while waiting, just skip it
+      if (--queued->count == 0)
+        pitEntry->RemoveFwTag<QueuedTag> ();
+
+      // entries evicted by the PIT policy go away without any strategy event, check
+      // that the entry is still the one held by the PIT for its name
+      if (this->m_pit->Find (pitEntry->GetPrefix ()) != pitEntry)
+        return true;
+
+      if (m_facePtrs[inId] == 0)
+        return true;
+
+      super::TrySendOutInterest (m_facePtrs[inId], m_facePtrs[outId], pitEntry->GetInterest (), pitEntry);
+      return true;
+    }
+
+  return false;
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::Forget (Ptr<pit::Entry> pitEntry)
+{
+  pitEntry->RemoveFwTag<QueuedTag> ();
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::WillSatisfyPendingInterest (Ptr<Face> inFace,
+                                                                         Ptr<pit::Entry> pitEntry)
+{
+  Forget (pitEntry);
+  super::WillSatisfyPendingInterest (inFace, pitEntry);
+}
+
+template<class Parent>
+void
+TokenBucketWithPerInterfaceFairness<Parent>::WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry)
+{
+  Forget (pitEntry);
+  super::WillEraseTimedOutPendingInterest (pitEntry);
+}
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#include <ns3/ndnSIM/model/fw/best-route.h>
+#include <ns3/ndnSIM/model/fw/per-out-face-limits.h>
+#include "satisfaction-based-pushback.h"
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+template class TokenBucketWithPerInterfaceFairness< PerOutFaceLimits<BestRoute> >;
+typedef TokenBucketWithPerInterfaceFairness< PerOutFaceLimits<BestRoute> > TokenBucketWithPerInterfaceFairnessPerOutFaceLimitsBestRoute;
+NS_OBJECT_ENSURE_REGISTERED (TokenBucketWithPerInterfaceFairnessPerOutFaceLimitsBestRoute);
+
+template class TokenBucketWithPerInterfaceFairness< SatisfactionBasedPushback< PerOutFaceLimits<BestRoute> > >;
+typedef TokenBucketWithPerInterfaceFairness< SatisfactionBasedPushback< PerOutFaceLimits<BestRoute> > > TokenBucketWithPerInterfaceFairnessSatisfactionBasedPushbackPerOutFaceLimitsBestRoute;
+NS_OBJECT_ENSURE_REGISTERED (TokenBucketWithPerInterfaceFairnessSatisfactionBasedPushbackPerOutFaceLimitsBestRoute);
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,132 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2012 University of California, Los Angeles
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Alexander Afanasyev <alexander.afanasyev@ucla.edu>
+ *         Salvatore Signorello <salvatore.signorello@uni.lu>
+ */
+
+#ifndef TOKEN_BUCKET_WITH_PER_INTERFACE_FAIRNESS_H
+#define TOKEN_BUCKET_WITH_PER_INTERFACE_FAIRNESS_H
+
+#include <ns3/event-id.h>
+#include <ns3/ndn-forwarding-strategy.h>
+#include "ns3/ndnSIM/model/fw/ndn-fw-tag.h"
+
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace fw {
+
+// Number of queues a PIT entry is waiting in, kept on the entry until it is satisfied or
+// times out: the queued Interests of an entry without the tag are skipped
+struct QueuedTag : public fw::Tag
+{
+  QueuedTag () : count (0) { }
+
+  uint32_t count;
+};
+
+/**
+ * \ingroup ndn-fw
+ * \brief Token bucket with per-interface fairness
+ *
+ * Interests which cannot be sent out of a face because its Limits are exhausted are
+ * queued, one queue per incoming face, and sent out when a slot gets available serving
+ * the incoming faces in round-robin, so a flooding downstream cannot take the share of
+ * the other ones.
+ *
+ * Queues are flat vectors indexed by face id; entries satisfied, timed out or evicted
+ * from the PIT while queued are skipped when they reach the head of their queue.
+ */
+template<class Parent>
+class TokenBucketWithPerInterfaceFairness :
+    public Parent
+{
+private:
+  typedef Parent super;
+
+public:
+  static TypeId
+  GetTypeId ();
+
+  static std::string
+  GetLogName ();
+
+  /**
+   * @brief Default constructor
+   */
+  TokenBucketWithPerInterfaceFairness ();
+
+  virtual void
+  AddFace (Ptr<Face> face);
+
+  virtual void
+  RemoveFace (Ptr<Face> face);
+
+  virtual void
+  WillEraseTimedOutPendingInterest (Ptr<pit::Entry> pitEntry);
+
+protected:
+  virtual bool
+  TrySendOutInterest (Ptr<Face> inFace,
+                      Ptr<Face> outFace,
+                      Ptr<const Interest> interest,
+                      Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  WillSatisfyPendingInterest (Ptr<Face> inFace,
+                              Ptr<pit::Entry> pitEntry);
+
+  virtual void
+  DoDispose ();
+
+private:
+  void
+  ProcessFromQueue ();
+
+  bool
+  SendFromQueue (uint32_t outFaceId);
+
+  void
+  Forget (Ptr<pit::Entry> pitEntry);
+
+private:
+  static LogComponent g_log;
+
+  // Interests waiting for one outgoing face, one FIFO per incoming face
+  struct OutQueue
+  {
+    OutQueue () : next (0), size (0) { }
+
+    std::vector< std::deque< Ptr<pit::Entry> > > perInFace;
+    uint32_t next; // next incoming face to be served
+    uint32_t size;
+  };
+
+  uint32_t m_maxQueueSize;
+
+  std::vector<Ptr<Face> > m_facePtrs; // faces by id
+  std::vector<OutQueue> m_queues; // by outgoing face id
+};
+
+} // namespace fw
+} // namespace ndn
+} // namespace ns3
+
+#endif // TOKEN_BUCKET_WITH_PER_INTERFACE_FAIRNESS_H
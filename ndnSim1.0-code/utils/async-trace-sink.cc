@@ -0,0 +1,171 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "async-trace-sink.h"
+
+#include <chrono>
+#include <sstream>
+
+namespace ns3 {
+namespace ndn {
+
+AsyncTraceSink::AsyncTraceSink (uint32_t capacity, Overflow overflow)
+  : m_overflow (overflow)
+  , m_head (0)
+  , m_tail (0)
+  , m_stop (false)
+  , m_written (0)
+  , m_dropped (0)
+  , m_backpressure (0)
+  , m_open (false)
+  , m_columnar (false)
+{
+  uint64_t size = 1;
+  while (size < capacity)
+    size <<= 1;
+  m_ring.resize (size);
+  m_mask = size - 1;
+}
+
+AsyncTraceSink::~AsyncTraceSink ()
+{
+  Close ();
+}
+
+bool
+AsyncTraceSink::Open (const std::string &file, bool columnar, const std::string &header, const std::vector<ColumnarKeyKind> &keys)
+{
+  if (m_open || keys.size () > TraceRecord::MAX_KEYS)
+    return false;
+
+  m_columnar = columnar;
+  m_header = header;
+  m_kinds = keys;
+  m_dictIds.assign (keys.size (), std::map<std::string, uint32_t> ());
+  m_dicts.assign (keys.size (), std::vector<std::string> ());
+  m_writerDicts.assign (keys.size (), std::vector<std::string> ());
+
+  if (columnar)
+    {
+      if (!m_columnarWriter.Open (file, header, keys))
+        return false;
+    }
+  else
+    {
+      m_text.open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+      if (!m_text.is_open ())
+        return false;
+      m_text << header << "\n";
+    }
+
+  m_stop.store (false);
+  m_open = true;
+  m_writer = std::thread (&AsyncTraceSink::Run, this);
+  return true;
+}
+
+uint32_t
+AsyncTraceSink::Intern (uint32_t column, const std::string &value)
+{
+  std::map<std::string, uint32_t>::iterator it = m_dictIds[column].find (value);
+  if (it != m_dictIds[column].end ())
+    return it->second;
+
+  std::lock_guard<std::mutex> lock (m_dictMutex);
+  uint32_t id = m_dicts[column].size ();
+  m_dictIds[column][value] = id;
+  m_dicts[column].push_back (value);
+  return id;
+}
+
+void
+AsyncTraceSink::SyncDictionaries (const TraceRecord &record)
+{
+  for (size_t k = 0; k < m_kinds.size (); k++)
+    {
+      if (m_kinds[k] != COLUMNAR_KEY_DICT || record.keys[k] < (int64_t)m_writerDicts[k].size ())
+        continue;
+
+      std::lock_guard<std::mutex> lock (m_dictMutex);
+      for (size_t id = m_writerDicts[k].size (); id < m_dicts[k].size (); id++)
+        {
+          m_writerDicts[k].push_back (m_dicts[k][id]);
+          if (m_columnar)
+            m_columnarWriter.Intern (k, m_dicts[k][id]); // same ids, interned in the same order
+        }
+    }
+}
+
+void
+AsyncTraceSink::Run ()
+{
+  std::ostringstream text;
+  for (;;)
+    {
+      // m_stop is read before the head, so the records pushed before Close are all written
+      bool stop = m_stop.load (std::memory_order_acquire);
+      uint64_t tail = m_tail.load (std::memory_order_relaxed);
+      uint64_t head = m_head.load (std::memory_order_acquire);
+
+      if (tail == head)
+        {
+          if (stop)
+            break;
+          std::this_thread::sleep_for (std::chrono::milliseconds (1));
+          continue;
+        }
+
+      for (; tail != head; tail++)
+        {
+          const TraceRecord &record = m_ring[tail & m_mask];
+          SyncDictionaries (record);
+          if (m_columnar)
+            m_columnarWriter.Append (record.time, record.keys, record.value);
+          else
+            PrintTraceRow (text, m_kinds, m_writerDicts, record.time, record.keys, record.value);
+        }
+      m_written.fetch_add (head - m_tail.load (std::memory_order_relaxed), std::memory_order_relaxed);
+      m_tail.store (tail, std::memory_order_release);
+
+      if (!m_columnar)
+        {
+          const std::string &buffer = text.str ();
+          m_text.write (buffer.data (), buffer.size ());
+          text.str (std::string ());
+        }
+    }
+}
+
+void
+AsyncTraceSink::Close ()
+{
+  if (!m_open)
+    return;
+
+  m_stop.store (true, std::memory_order_release);
+  m_writer.join ();
+  m_open = false;
+
+  if (m_columnar)
+    m_columnarWriter.Close ();
+  else
+    m_text.close ();
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,180 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASYNC_TRACE_SINK_H_
+#define ASYNC_TRACE_SINK_H_
+
+#include "columnar-trace.h"
+
+// the writer thread needs the C++11 thread support library, see the README
+#if __cplusplus < 201103L
+#error "async-trace-sink.h requires C++11, configure waf with CXXFLAGS=\"-std=c++11\""
+#endif
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Trace record as pushed by the simulator thread: time, keys and value of a
+ * row of the tracers' output (see columnar-trace.h)
+ */
+struct TraceRecord
+{
+  enum { MAX_KEYS = 4 };
+
+  int64_t time; // nanoseconds
+  int64_t keys[MAX_KEYS]; // dictionary ids for the string columns
+  double value;
+};
+
+/**
+ * @brief Trace output written by a background thread
+ *
+ * The simulator thread only copies fixed-size records into a single-producer
+ * single-consumer ring buffer, a writer thread drains it and does the formatting (text)
+ * or the encoding (columnar) and the write calls, so that the simulation never waits
+ * for the disk. When the ring is full the record is either dropped or the producer
+ * waits for the writer (backpressure), both events are counted.
+ *
+ * Strings of the dictionary key columns are interned by the producer, the writer
+ * fetches the new ones under a lock only when it meets an id it does not know yet.
+ */
+class AsyncTraceSink
+{
+public:
+  enum Overflow { OVERFLOW_BLOCK, OVERFLOW_DROP };
+
+  /**
+   * @param capacity number of records of the ring, rounded up to a power of two
+   */
+  AsyncTraceSink (uint32_t capacity = 65536, Overflow overflow = OVERFLOW_BLOCK);
+
+  ~AsyncTraceSink ();
+
+  /**
+   * @brief Opens the output file and starts the writer thread
+   * @param columnar columnar format when true, text otherwise
+   * @param header header line of the text format
+   * @param keys kind of each key column, at most TraceRecord::MAX_KEYS
+   */
+  bool
+  Open (const std::string &file, bool columnar, const std::string &header, const std::vector<ColumnarKeyKind> &keys);
+
+  /**
+   * @brief Id of a string of a dictionary key column, to be put in the records
+   */
+  uint32_t
+  Intern (uint32_t column, const std::string &value);
+
+  /**
+   * @return false if the record was dropped because the ring was full
+   */
+  inline bool
+  Push (const TraceRecord &record);
+
+  /**
+   * @brief Drains the ring, stops the writer thread and closes the file
+   */
+  void
+  Close ();
+
+  uint64_t
+  GetWritten () const { return m_written.load (std::memory_order_relaxed); }
+
+  uint64_t
+  GetDropped () const { return m_dropped.load (std::memory_order_relaxed); }
+
+  /**
+   * @brief Number of records for which the producer had to wait for the writer
+   */
+  uint64_t
+  GetBackpressure () const { return m_backpressure.load (std::memory_order_relaxed); }
+
+private:
+  void
+  Run ();
+
+  void
+  SyncDictionaries (const TraceRecord &record);
+
+private:
+  std::vector<TraceRecord> m_ring;
+  uint64_t m_mask;
+  Overflow m_overflow;
+
+  // producer and consumer positions on separate cache lines
+  alignas (64) std::atomic<uint64_t> m_head; // next record to be pushed
+  alignas (64) std::atomic<uint64_t> m_tail; // next record to be written
+  alignas (64) std::atomic<bool> m_stop;
+
+  std::atomic<uint64_t> m_written;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_backpressure;
+
+  std::thread m_writer;
+  bool m_open;
+
+  std::vector<ColumnarKeyKind> m_kinds;
+  std::string m_header;
+
+  // producer side dictionaries, m_dicts is shared with the writer under m_dictMutex
+  std::vector<std::map<std::string, uint32_t> > m_dictIds;
+  std::vector<std::vector<std::string> > m_dicts;
+  std::mutex m_dictMutex;
+
+  // writer side
+  std::vector<std::vector<std::string> > m_writerDicts;
+  bool m_columnar;
+  std::ofstream m_text;
+  ColumnarTraceWriter m_columnarWriter;
+};
+
+inline bool
+AsyncTraceSink::Push (const TraceRecord &record)
+{
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  if (head - m_tail.load (std::memory_order_acquire) > m_mask)
+    {
+      if (m_overflow == OVERFLOW_DROP || !m_open)
+        {
+          m_dropped.fetch_add (1, std::memory_order_relaxed);
+          return false;
+        }
+
+      m_backpressure.fetch_add (1, std::memory_order_relaxed);
+      while (head - m_tail.load (std::memory_order_acquire) > m_mask)
+        std::this_thread::yield ();
+    }
+
+  m_ring[head & m_mask] = record;
+  m_head.store (head + 1, std::memory_order_release);
+  return true;
+}
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_SINK_H_ */
@@ -0,0 +1,643 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "columnar-trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+namespace ndn {
+
+static const char g_magic[8] = { 'N', 'D', 'N', 'C', 'T', 'R', '1', 0 };
+static const char g_trailerMagic[8] = { 'N', 'D', 'N', 'C', 'T', 'R', 'I', 'X' };
+
+//////////////////////////////////////////////////////////////////////////////
+// Encoding helpers
+
+static inline uint64_t
+ZigZag (int64_t value)
+{
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t
+UnZigZag (uint64_t value)
+{
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline void
+PutVarint (std::string &out, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      out.push_back ((char)(value | 0x80));
+      value >>= 7;
+    }
+  out.push_back ((char)value);
+}
+
+static inline void
+PutFixed64 (std::string &out, uint64_t value)
+{
+  for (int i = 0; i < 8; i++)
+    out.push_back ((char)(value >> (8 * i)));
+}
+
+// Bounded reader over an in-memory buffer, reads past the end return 0 and set the
+// error flag
+class ByteReader
+{
+public:
+  ByteReader (const std::string &buffer) : m_buffer (buffer), m_pos (0), m_error (false) { }
+
+  uint64_t
+  Varint ()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+      {
+        if (m_pos >= m_buffer.size ())
+          {
+            m_error = true;
+            return 0;
+          }
+        uint8_t byte = m_buffer[m_pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+          return value;
+      }
+    m_error = true;
+    return value;
+  }
+
+  uint64_t
+  Fixed64 ()
+  {
+    if (m_pos + 8 > m_buffer.size ())
+      {
+        m_error = true;
+        return 0;
+      }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+      value |= (uint64_t)(uint8_t)m_buffer[m_pos++] << (8 * i);
+    return value;
+  }
+
+  std::string
+  Bytes (size_t length)
+  {
+    if (m_pos + length > m_buffer.size ())
+      {
+        m_error = true;
+        return std::string ();
+      }
+    m_pos += length;
+    return m_buffer.substr (m_pos - length, length);
+  }
+
+  bool
+  Error () const { return m_error; }
+
+private:
+  const std::string &m_buffer;
+  size_t m_pos;
+  bool m_error;
+};
+
+class BitWriter
+{
+public:
+  BitWriter (std::string &out) : m_out (out), m_byte (0), m_bits (0) { }
+
+  void
+  Put (uint64_t value, uint32_t bits)
+  {
+    while (bits > 0)
+      {
+        bits--;
+        m_byte = (m_byte << 1) | ((value >> bits) & 1);
+        if (++m_bits == 8)
+          {
+            m_out.push_back ((char)m_byte);
+            m_byte = 0;
+            m_bits = 0;
+          }
+      }
+  }
+
+  void
+  Finish ()
+  {
+    if (m_bits > 0)
+      Put (0, 8 - m_bits);
+  }
+
+private:
+  std::string &m_out;
+  uint8_t m_byte;
+  uint32_t m_bits;
+};
+
+class BitReader
+{
+public:
+  BitReader (const std::string &in) : m_in (in), m_pos (0), m_error (false) { }
+
+  uint64_t
+  Get (uint32_t bits)
+  {
+    uint64_t value = 0;
+    while (bits > 0)
+      {
+        if ((m_pos >> 3) >= m_in.size ())
+          {
+            m_error = true;
+            return value;
+          }
+        value = (value << 1) | (((uint8_t)m_in[m_pos >> 3] >> (7 - (m_pos & 7))) & 1);
+        m_pos++;
+        bits--;
+      }
+    return value;
+  }
+
+  bool
+  Error () const { return m_error; }
+
+private:
+  const std::string &m_in;
+  size_t m_pos;
+  bool m_error;
+};
+
+static inline uint64_t
+DoubleBits (double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  return bits;
+}
+
+static inline double
+BitsDouble (uint64_t bits)
+{
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+static inline uint32_t
+LeadingZeros (uint64_t value)
+{
+  uint32_t n = 0;
+  for (uint64_t mask = 1ULL << 63; mask != 0 && !(value & mask); mask >>= 1)
+    n++;
+  return n;
+}
+
+static inline uint32_t
+TrailingZeros (uint64_t value)
+{
+  uint32_t n = 0;
+  for (uint64_t mask = 1; mask != 0 && !(value & mask); mask <<= 1)
+    n++;
+  return n;
+}
+
+// XOR state of a series, the first value of a series in a block is XORed with 0
+struct GorillaState
+{
+  GorillaState () : prev (0), leading (0xff), trailing (0) { }
+
+  uint64_t prev;
+  uint32_t leading; // 0xff until a window is set
+  uint32_t trailing;
+};
+
+static void
+GorillaPut (BitWriter &bits, GorillaState &state, double value)
+{
+  uint64_t current = DoubleBits (value);
+  uint64_t x = current ^ state.prev;
+  state.prev = current;
+
+  if (x == 0)
+    {
+      bits.Put (0, 1);
+      return;
+    }
+  bits.Put (1, 1);
+
+  uint32_t leading = std::min (LeadingZeros (x), 31u);
+  uint32_t trailing = TrailingZeros (x);
+  if (state.leading != 0xff && leading >= state.leading && trailing >= state.trailing)
+    {
+      // the meaningful bits fit in the previous window
+      bits.Put (0, 1);
+      bits.Put (x >> state.trailing, 64 - state.leading - state.trailing);
+      return;
+    }
+
+  uint32_t meaningful = 64 - leading - trailing;
+  bits.Put (1, 1);
+  bits.Put (leading, 5);
+  bits.Put (meaningful & 0x3f, 6); // 64 is written as 0
+  bits.Put (x >> trailing, meaningful);
+  state.leading = leading;
+  state.trailing = trailing;
+}
+
+static double
+GorillaGet (BitReader &bits, GorillaState &state)
+{
+  if (bits.Get (1) != 0)
+    {
+      if (bits.Get (1) != 0)
+        {
+          state.leading = bits.Get (5);
+          uint32_t meaningful = bits.Get (6);
+          if (meaningful == 0)
+            meaningful = 64;
+          state.trailing = 64 - state.leading - meaningful;
+        }
+      uint32_t meaningful = 64 - state.leading - state.trailing;
+      state.prev ^= bits.Get (meaningful) << state.trailing;
+    }
+  return BitsDouble (state.prev);
+}
+
+void
+PrintTraceRow (std::ostream &os, const std::vector<ColumnarKeyKind> &kinds,
+               const std::vector<std::vector<std::string> > &dicts,
+               int64_t time, const int64_t *keys, double value)
+{
+  os << time / 1e9 << "\t";
+  for (size_t k = 0; k < kinds.size (); k++)
+    {
+      if (kinds[k] == COLUMNAR_KEY_DICT)
+        os << dicts[k][keys[k]] << "\t";
+      else
+        os << keys[k] << "\t";
+    }
+
+  // counters are printed as integers, as the tracers do
+  if (value == std::floor (value) && std::fabs (value) < 9.2e18)
+    os << (int64_t)value << "\n";
+  else
+    os << value << "\n";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Writer
+
+ColumnarTraceWriter::ColumnarTraceWriter (uint32_t blockRows)
+  : m_blockRows (blockRows)
+{
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter ()
+{
+  Close ();
+}
+
+bool
+ColumnarTraceWriter::Open (const std::string &file, const std::string &header, const std::vector<ColumnarKeyKind> &keys)
+{
+  m_os.open (file.c_str (), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  if (!m_os.is_open ())
+    return false;
+
+  m_kinds = keys;
+  m_dictIds.assign (keys.size (), std::map<std::string, uint32_t> ());
+  m_dicts.assign (keys.size (), std::vector<std::string> ());
+  m_keys.assign (keys.size (), std::vector<int64_t> ());
+  m_index.clear ();
+
+  std::string out (g_magic, sizeof (g_magic));
+  PutVarint (out, header.size ());
+  out.append (header);
+  PutVarint (out, keys.size ());
+  for (size_t k = 0; k < keys.size (); k++)
+    out.push_back ((char)keys[k]);
+  m_os.write (out.data (), out.size ());
+  return true;
+}
+
+uint32_t
+ColumnarTraceWriter::Intern (uint32_t column, const std::string &value)
+{
+  std::map<std::string, uint32_t>::iterator it = m_dictIds[column].find (value);
+  if (it != m_dictIds[column].end ())
+    return it->second;
+
+  uint32_t id = m_dicts[column].size ();
+  m_dictIds[column][value] = id;
+  m_dicts[column].push_back (value);
+  return id;
+}
+
+void
+ColumnarTraceWriter::Append (int64_t time, const int64_t *keys, double value)
+{
+  if (!m_os.is_open ())
+    return;
+
+  m_times.push_back (time);
+  for (size_t k = 0; k < m_keys.size (); k++)
+    m_keys[k].push_back (keys[k]);
+  m_values.push_back (value);
+
+  if (m_times.size () >= m_blockRows)
+    FlushBlock ();
+}
+
+void
+ColumnarTraceWriter::FlushBlock ()
+{
+  if (m_times.empty ())
+    return;
+
+  uint32_t rows = m_times.size ();
+  std::string out;
+  PutVarint (out, rows);
+
+  int64_t prev = 0;
+  for (uint32_t r = 0; r < rows; r++)
+    {
+      PutVarint (out, ZigZag (m_times[r] - prev));
+      prev = m_times[r];
+    }
+
+  for (size_t k = 0; k < m_keys.size (); k++)
+    {
+      std::string runs;
+      uint32_t nRuns = 0;
+      for (uint32_t r = 0; r < rows; )
+        {
+          uint32_t run = 1;
+          while (r + run < rows && m_keys[k][r + run] == m_keys[k][r])
+            run++;
+          PutVarint (runs, ZigZag (m_keys[k][r]));
+          PutVarint (runs, run);
+          nRuns++;
+          r += run;
+        }
+      PutVarint (out, nRuns);
+      out.append (runs);
+    }
+
+  // series are identified by their keys, in order of appearance in the block
+  std::map<std::vector<int64_t>, GorillaState> series;
+  std::vector<int64_t> key (m_keys.size ());
+  std::string values;
+  BitWriter bits (values);
+  for (uint32_t r = 0; r < rows; r++)
+    {
+      for (size_t k = 0; k < m_keys.size (); k++)
+        key[k] = m_keys[k][r];
+      GorillaPut (bits, series[key], m_values[r]);
+    }
+  bits.Finish ();
+  PutVarint (out, values.size ());
+  out.append (values);
+
+  BlockInfo info;
+  info.offset = m_os.tellp ();
+  info.rows = rows;
+  info.firstTime = m_times.front ();
+  info.lastTime = m_times.back ();
+  m_index.push_back (info);
+
+  m_os.write (out.data (), out.size ());
+
+  m_times.clear ();
+  for (size_t k = 0; k < m_keys.size (); k++)
+    m_keys[k].clear ();
+  m_values.clear ();
+}
+
+void
+ColumnarTraceWriter::Close ()
+{
+  if (!m_os.is_open ())
+    return;
+
+  FlushBlock ();
+
+  uint64_t footerOffset = m_os.tellp ();
+  std::string out;
+  for (size_t k = 0; k < m_kinds.size (); k++)
+    {
+      if (m_kinds[k] != COLUMNAR_KEY_DICT)
+        continue;
+      PutVarint (out, m_dicts[k].size ());
+      for (size_t i = 0; i < m_dicts[k].size (); i++)
+        {
+          PutVarint (out, m_dicts[k][i].size ());
+          out.append (m_dicts[k][i]);
+        }
+    }
+
+  PutVarint (out, m_index.size ());
+  for (size_t b = 0; b < m_index.size (); b++)
+    {
+      PutFixed64 (out, m_index[b].offset);
+      PutVarint (out, m_index[b].rows);
+      PutVarint (out, ZigZag (m_index[b].firstTime));
+      PutVarint (out, ZigZag (m_index[b].lastTime));
+    }
+
+  PutFixed64 (out, footerOffset);
+  out.append (g_trailerMagic, sizeof (g_trailerMagic));
+  m_os.write (out.data (), out.size ());
+  m_os.close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Reader
+
+bool
+ColumnarTraceReader::Open (const std::string &file)
+{
+  m_is.open (file.c_str (), std::ios_base::in | std::ios_base::binary);
+  if (!m_is.is_open ())
+    return false;
+
+  m_is.seekg (0, std::ios_base::end);
+  uint64_t size = m_is.tellg ();
+  if (size < 2 * sizeof (g_magic) + 8)
+    return false;
+
+  // trailer: footer offset and magic
+  std::string trailer (16, 0);
+  m_is.seekg (size - 16);
+  m_is.read (&trailer[0], 16);
+  if (std::memcmp (trailer.data () + 8, g_trailerMagic, sizeof (g_trailerMagic)) != 0)
+    return false; // not a columnar trace or the writer was not closed
+  ByteReader trailerReader (trailer);
+  uint64_t footerOffset = trailerReader.Fixed64 ();
+  if (footerOffset > size - 16)
+    return false;
+
+  std::string head (std::min<uint64_t> (footerOffset, 64 * 1024), 0);
+  m_is.seekg (0);
+  m_is.read (&head[0], head.size ());
+  if (std::memcmp (head.data (), g_magic, sizeof (g_magic)) != 0)
+    return false;
+  head = head.substr (sizeof (g_magic));
+  ByteReader headReader (head);
+  m_header = headReader.Bytes (headReader.Varint ());
+  uint64_t nKeys = headReader.Varint ();
+  if (headReader.Error () || nKeys > 255)
+    return false;
+  std::string kinds = headReader.Bytes (nKeys);
+  m_kinds.clear ();
+  for (size_t k = 0; k < kinds.size (); k++)
+    m_kinds.push_back ((ColumnarKeyKind)kinds[k]);
+
+  std::string footer (size - 16 - footerOffset, 0);
+  m_is.seekg (footerOffset);
+  m_is.read (&footer[0], footer.size ());
+  ByteReader footerReader (footer);
+
+  m_dicts.assign (m_kinds.size (), std::vector<std::string> ());
+  for (size_t k = 0; k < m_kinds.size (); k++)
+    {
+      if (m_kinds[k] != COLUMNAR_KEY_DICT)
+        continue;
+      uint64_t n = footerReader.Varint ();
+      for (uint64_t i = 0; i < n && !footerReader.Error (); i++)
+        m_dicts[k].push_back (footerReader.Bytes (footerReader.Varint ()));
+    }
+
+  uint64_t nBlocks = footerReader.Varint ();
+  m_index.clear ();
+  for (uint64_t b = 0; b < nBlocks && !footerReader.Error (); b++)
+    {
+      BlockInfo info;
+      info.offset = footerReader.Fixed64 ();
+      info.rows = footerReader.Varint ();
+      info.firstTime = UnZigZag (footerReader.Varint ());
+      info.lastTime = UnZigZag (footerReader.Varint ());
+      m_index.push_back (info);
+    }
+
+  return !footerReader.Error ();
+}
+
+bool
+ColumnarTraceReader::ReadBlock (uint32_t block, std::vector<ColumnarTraceRow> &rows)
+{
+  if (block >= m_index.size ())
+    return false;
+
+  uint64_t end = (block + 1 < m_index.size ()) ? m_index[block + 1].offset : 0;
+  if (end == 0)
+    {
+      // the last block ends where the footer starts
+      m_is.seekg (-16, std::ios_base::end);
+      std::string trailer (8, 0);
+      m_is.read (&trailer[0], 8);
+      ByteReader trailerReader (trailer);
+      end = trailerReader.Fixed64 ();
+    }
+  if (end < m_index[block].offset)
+    return false;
+
+  std::string buffer (end - m_index[block].offset, 0);
+  m_is.seekg (m_index[block].offset);
+  m_is.read (&buffer[0], buffer.size ());
+  ByteReader reader (buffer);
+
+  uint32_t nRows = reader.Varint ();
+  if (reader.Error () || nRows != m_index[block].rows)
+    return false;
+
+  rows.assign (nRows, ColumnarTraceRow ());
+  int64_t time = 0;
+  for (uint32_t r = 0; r < nRows; r++)
+    {
+      time += UnZigZag (reader.Varint ());
+      rows[r].time = time;
+      rows[r].keys.resize (m_kinds.size ());
+    }
+
+  for (size_t k = 0; k < m_kinds.size (); k++)
+    {
+      uint64_t nRuns = reader.Varint ();
+      uint32_t r = 0;
+      for (uint64_t i = 0; i < nRuns && !reader.Error (); i++)
+        {
+          int64_t value = UnZigZag (reader.Varint ());
+          uint64_t run = reader.Varint ();
+          for (uint64_t j = 0; j < run && r < nRows; j++)
+            rows[r++].keys[k] = value;
+        }
+      if (r != nRows)
+        return false;
+    }
+
+  std::string values = reader.Bytes (reader.Varint ());
+  if (reader.Error ())
+    return false;
+
+  std::map<std::vector<int64_t>, GorillaState> series;
+  BitReader bits (values);
+  for (uint32_t r = 0; r < nRows; r++)
+    rows[r].value = GorillaGet (bits, series[rows[r].keys]);
+
+  return !bits.Error ();
+}
+
+void
+ColumnarTraceReader::PrintRow (std::ostream &os, const ColumnarTraceRow &row) const
+{
+  PrintTraceRow (os, m_kinds, m_dicts, row.time, &row.keys[0], row.value);
+}
+
+bool
+ColumnarTraceReader::PrintText (std::ostream &os, double from, double to)
+{
+  os << m_header << "\n";
+
+  std::vector<ColumnarTraceRow> rows;
+  for (uint32_t b = 0; b < m_index.size (); b++)
+    {
+      if ((from >= 0 && m_index[b].lastTime / 1e9 < from) ||
+          (to >= 0 && m_index[b].firstTime / 1e9 > to))
+        continue;
+
+      if (!ReadBlock (b, rows))
+        return false;
+
+      for (size_t r = 0; r < rows.size (); r++)
+        {
+          double time = rows[r].time / 1e9;
+          if ((from < 0 || time >= from) && (to < 0 || time <= to))
+            PrintRow (os, rows[r]);
+        }
+    }
+  return true;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,194 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLUMNAR_TRACE_H_
+#define COLUMNAR_TRACE_H_
+
+#include <stdint.h>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/*
+ * Binary columnar format of the tracers' output, whose rows are
+ *
+ *   Time <key 1> ... <key K> Value
+ *
+ * e.g., Time Node Type Signal Value for the InterestTracer. Keys are either strings,
+ * dictionary-encoded, or integers. Rows are stored in blocks of columns:
+ *  - time: nanoseconds, delta-encoded as zigzag varints
+ *  - keys: run-length encoded (value, run) varint pairs
+ *  - value: doubles XOR-compressed as in Gorilla (Facebook, VLDB 2015), each value
+ *    against the previous one of the same series (same keys) in the block
+ * Every block can be decoded on its own. The footer holds the dictionaries and the
+ * block index (offset, rows, first and last time), the file ends with the offset of
+ * the footer, so the file is only readable once the writer has been closed.
+ *
+ * The library does not depend on ns-3, so the reader can be built on its own to
+ * convert the traces back to the text format (see columnar-trace-dump.cc).
+ */
+
+enum ColumnarKeyKind { COLUMNAR_KEY_DICT = 0, COLUMNAR_KEY_INT = 1 };
+
+/**
+ * @brief Prints a row in the text format of the tracers: time in seconds, keys and value
+ * separated by tabs, integral values printed as integers
+ */
+void
+PrintTraceRow (std::ostream &os, const std::vector<ColumnarKeyKind> &kinds,
+               const std::vector<std::vector<std::string> > &dicts,
+               int64_t time, const int64_t *keys, double value);
+
+class ColumnarTraceWriter
+{
+public:
+  ColumnarTraceWriter (uint32_t blockRows = 4096);
+
+  ~ColumnarTraceWriter ();
+
+  /**
+   * @brief Opens the file and writes the file header
+   * @param header header line of the text format, reproduced by the reader
+   * @param keys kind of each key column
+   */
+  bool
+  Open (const std::string &file, const std::string &header, const std::vector<ColumnarKeyKind> &keys);
+
+  /**
+   * @brief Id of a string of a dictionary key column, to be passed to Append
+   */
+  uint32_t
+  Intern (uint32_t column, const std::string &value);
+
+  /**
+   * @brief Appends a row
+   * @param time nanoseconds
+   * @param keys one value per key column, dictionary ids for the string columns
+   */
+  void
+  Append (int64_t time, const int64_t *keys, double value);
+
+  /**
+   * @brief Writes the last block, the dictionaries and the block index
+   */
+  void
+  Close ();
+
+private:
+  void
+  FlushBlock ();
+
+private:
+  struct BlockInfo
+  {
+    uint64_t offset;
+    uint32_t rows;
+    int64_t firstTime;
+    int64_t lastTime;
+  };
+
+  std::ofstream m_os;
+  uint32_t m_blockRows;
+  std::vector<ColumnarKeyKind> m_kinds;
+
+  std::vector<std::map<std::string, uint32_t> > m_dictIds; // by key column
+  std::vector<std::vector<std::string> > m_dicts;
+
+  // current block, by column
+  std::vector<int64_t> m_times;
+  std::vector<std::vector<int64_t> > m_keys;
+  std::vector<double> m_values;
+
+  std::vector<BlockInfo> m_index;
+};
+
+struct ColumnarTraceRow
+{
+  int64_t time; // nanoseconds
+  std::vector<int64_t> keys;
+  double value;
+};
+
+class ColumnarTraceReader
+{
+public:
+  struct BlockInfo
+  {
+    uint64_t offset;
+    uint32_t rows;
+    int64_t firstTime;
+    int64_t lastTime;
+  };
+
+  /**
+   * @brief Reads the header, the dictionaries and the block index
+   */
+  bool
+  Open (const std::string &file);
+
+  const std::string &
+  GetHeader () const { return m_header; }
+
+  uint32_t
+  GetNKeys () const { return m_kinds.size (); }
+
+  ColumnarKeyKind
+  GetKeyKind (uint32_t column) const { return m_kinds[column]; }
+
+  /**
+   * @brief String of a dictionary key column
+   */
+  const std::string &
+  GetString (uint32_t column, int64_t id) const { return m_dicts[column][id]; }
+
+  const std::vector<BlockInfo> &
+  GetIndex () const { return m_index; }
+
+  bool
+  ReadBlock (uint32_t block, std::vector<ColumnarTraceRow> &rows);
+
+  /**
+   * @brief Prints the rows with time in [from, to] seconds in the text format of the
+   * tracer, header line included. Blocks out of the interval are not decoded.
+   */
+  bool
+  PrintText (std::ostream &os, double from = -1, double to = -1);
+
+  /**
+   * @brief Prints one row as the tracer would have printed it
+   */
+  void
+  PrintRow (std::ostream &os, const ColumnarTraceRow &row) const;
+
+private:
+  std::ifstream m_is;
+  std::string m_header;
+  std::vector<ColumnarKeyKind> m_kinds;
+  std::vector<std::vector<std::string> > m_dicts;
+  std::vector<BlockInfo> m_index;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_H_ */
@@ -0,0 +1,96 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "event-log.h"
+
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("ndn.EventLog");
+
+namespace ns3 {
+namespace ndn {
+
+static const char *g_header = "Time\tEvent\tNode\tFace\tName\tValue\t";
+
+static const char *g_eventNames[EventLog::EVENTS] = {
+  "ConsumerInterest",
+  "ConsumerData",
+  "ConsumerNack",
+  "ProducerInterest",
+  "ProducerData",
+  "ProducerReject",
+  "AttackerInterest"
+};
+
+AsyncTraceSink *EventLog::m_sink = 0;
+int64_t EventLog::m_eventKeys[EventLog::EVENTS];
+
+bool
+EventLog::Open (const std::string &file)
+{
+  Close ();
+
+  std::vector<ColumnarKeyKind> keys;
+  keys.push_back (COLUMNAR_KEY_DICT); // Event
+  keys.push_back (COLUMNAR_KEY_INT); // Node
+  keys.push_back (COLUMNAR_KEY_INT); // Face
+  keys.push_back (COLUMNAR_KEY_DICT); // Name
+
+  AsyncTraceSink *sink = new AsyncTraceSink ();
+  if (!sink->Open (file, true, g_header, keys))
+    {
+      NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Event log disabled");
+      delete sink;
+      return false;
+    }
+
+  for (uint32_t event = 0; event < EVENTS; event++)
+    m_eventKeys[event] = sink->Intern (0, g_eventNames[event]);
+  m_sink = sink;
+  return true;
+}
+
+void
+EventLog::Close ()
+{
+  if (m_sink == 0)
+    return;
+
+  m_sink->Close ();
+  if (m_sink->GetDropped () > 0)
+    NS_LOG_WARN (m_sink->GetDropped () << " events dropped");
+  delete m_sink;
+  m_sink = 0;
+}
+
+void
+EventLog::Push (Event event, uint32_t node, uint32_t face, const std::string &name, uint32_t value)
+{
+  TraceRecord record;
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.keys[0] = m_eventKeys[event];
+  record.keys[1] = node;
+  record.keys[2] = face;
+  record.keys[3] = m_sink->Intern (3, name);
+  record.value = value;
+  m_sink->Push (record);
+}
+
+} // namespace ndn
+} // namespace ns3
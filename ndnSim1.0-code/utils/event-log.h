@@ -0,0 +1,100 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EVENT_LOG_H_
+#define EVENT_LOG_H_
+
+#include "async-trace-sink.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Packet-level events of the applications, in place of the per-packet NS_LOG_INFO
+ *
+ * Every event is a fixed-size record (time, event, node, face, name and an argument)
+ * pushed to an AsyncTraceSink and written by its background thread in the columnar
+ * format, so the simulator thread never formats a string. Names are interned in a
+ * dictionary the first time they are seen. The log is turned back into text offline
+ * with columnar-trace-dump, whose rows are
+ *
+ *   Time Event Node Face Name Value
+ *
+ * where Name is the last name component (the title, for segments), and Value is the
+ * sequence number for the consumers and the attackers, the segment for the segment
+ * consumer and for the Interests, the Data and the rejections of the producers (0 for
+ * the names which are not segmented).
+ *
+ * Nothing is recorded until Open is called, Record then costs a single test.
+ */
+class EventLog
+{
+public:
+  enum Event
+  {
+    CONSUMER_INTEREST = 0,
+    CONSUMER_DATA,
+    CONSUMER_NACK,
+    PRODUCER_INTEREST,
+    PRODUCER_DATA,
+    PRODUCER_REJECT, // Interest for a name the producer does not have
+    ATTACKER_INTEREST,
+    EVENTS
+  };
+
+  /**
+   * @brief Starts recording to file, any event recorded before is lost
+   */
+  static bool
+  Open (const std::string &file);
+
+  /**
+   * @brief Drains the pending records and closes the file, which only becomes readable then
+   */
+  static void
+  Close ();
+
+  static bool
+  IsOpen () { return m_sink != 0; }
+
+  static void
+  Record (Event event, uint32_t node, uint32_t face, const std::string &name, uint32_t value)
+  {
+    if (m_sink != 0)
+      Push (event, node, face, name, value);
+  }
+
+  static uint64_t
+  GetDropped () { return m_sink != 0 ? m_sink->GetDropped () : 0; }
+
+private:
+  static void
+  Push (Event event, uint32_t node, uint32_t face, const std::string &name, uint32_t value);
+
+private:
+  static AsyncTraceSink *m_sink;
+  static int64_t m_eventKeys[EVENTS];
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* EVENT_LOG_H_ */
@@ -0,0 +1,108 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hot-path-profiler.h"
+
+#ifdef NDN_HOTPATH_PROFILING
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#endif
+
+namespace ns3 {
+namespace ndn {
+
+#ifdef NDN_HOTPATH_PROFILING
+static ProfileSite *g_sites = 0;
+
+// reference points to measure the rate of the counter
+static uint64_t g_startTicks = 0;
+static std::chrono::steady_clock::time_point g_startTime;
+
+ProfileSite::ProfileSite (const char *component, const char *name)
+  : component (component)
+  , name (name)
+  , count (0)
+  , total (0)
+  , max (0)
+  , next (g_sites)
+{
+  if (g_sites == 0)
+    {
+      g_startTicks = ProfileScope::Now ();
+      g_startTime = std::chrono::steady_clock::now ();
+    }
+  g_sites = this;
+}
+
+static bool
+CompareSites (const ProfileSite *a, const ProfileSite *b)
+{
+  int component = std::strcmp (a->component, b->component);
+  if (component != 0)
+    return component < 0;
+  return a->total > b->total;
+}
+#endif // NDN_HOTPATH_PROFILING
+
+void
+HotPathProfiler::Print (std::ostream &os)
+{
+  os << "Component\tSite\tCount\tTotalMs\tMeanNs\tMaxNs\n";
+#ifdef NDN_HOTPATH_PROFILING
+  if (g_sites == 0)
+    return;
+
+  double elapsedNs = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - g_startTime).count ();
+  uint64_t elapsedTicks = ProfileScope::Now () - g_startTicks;
+  double nsPerTick = elapsedTicks > 0 ? elapsedNs / elapsedTicks : 1.0;
+
+  std::vector<ProfileSite *> sites;
+  for (ProfileSite *site = g_sites; site != 0; site = site->next)
+    sites.push_back (site);
+  std::sort (sites.begin (), sites.end (), CompareSites);
+
+  for (std::vector<ProfileSite *>::const_iterator it = sites.begin (); it != sites.end (); ++it)
+    {
+      const ProfileSite &site = **it;
+      os << site.component << "\t"
+         << site.name << "\t"
+         << site.count << "\t"
+         << site.total * nsPerTick / 1e6 << "\t"
+         << (site.count > 0 ? site.total * nsPerTick / site.count : 0) << "\t"
+         << site.max * nsPerTick << "\n";
+    }
+#endif
+}
+
+void
+HotPathProfiler::Reset ()
+{
+#ifdef NDN_HOTPATH_PROFILING
+  for (ProfileSite *site = g_sites; site != 0; site = site->next)
+    {
+      site->count = 0;
+      site->total = 0;
+      site->max = 0;
+    }
+#endif
+}
+
+} // namespace ndn
+} // namespace ns3
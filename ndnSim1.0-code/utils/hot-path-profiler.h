@@ -0,0 +1,134 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOT_PATH_PROFILER_H_
+#define HOT_PATH_PROFILER_H_
+
+#include <stdint.h>
+#include <ostream>
+
+#ifdef NDN_HOTPATH_PROFILING
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+/*
+ * Scoped timers for the per-packet entry points of the strategies and of the apps.
+ *
+ * NDN_PROFILE_SCOPE (component, site) placed at the top of a function times the rest of
+ * the enclosing scope with the time-stamp counter and aggregates count, total and max
+ * per site. Nested sites are inclusive, e.g., the time of SatisfyPendingInterest is also
+ * part of the OnData of the caller. HotPathProfiler::Print writes the table at the end of
+ * the run.
+ *
+ * Profiling is enabled by defining NDN_HOTPATH_PROFILING, e.g., by adding
+ * -DNDN_HOTPATH_PROFILING to CXXFLAGS when configuring waf. Otherwise everything is
+ * compiled out: the macro expands to nothing and HotPathProfiler::Print only writes
+ * the header of the table.
+ */
+
+#ifdef NDN_HOTPATH_PROFILING
+#define NDN_PROFILE_SCOPE(component, site)                                    \
+  static ::ns3::ndn::ProfileSite ndnProfileSite_ (component, site);           \
+  ::ns3::ndn::ProfileScope ndnProfileScope_ (ndnProfileSite_)
+#else
+#define NDN_PROFILE_SCOPE(component, site)
+#endif
+
+namespace ns3 {
+namespace ndn {
+
+#ifdef NDN_HOTPATH_PROFILING
+/**
+ * @brief Aggregated timings of a profiled site, registered on its first execution
+ */
+struct ProfileSite
+{
+  ProfileSite (const char *component, const char *name);
+
+  const char *component;
+  const char *name;
+  uint64_t count;
+  uint64_t total; // ticks
+  uint64_t max;
+  ProfileSite *next; // list of the registered sites
+};
+
+class ProfileScope
+{
+public:
+  explicit
+  ProfileScope (ProfileSite &site)
+    : m_site (site)
+    , m_start (Now ())
+  {
+  }
+
+  ~ProfileScope ()
+  {
+    uint64_t ticks = Now () - m_start;
+    m_site.count++;
+    m_site.total += ticks;
+    if (ticks > m_site.max)
+      m_site.max = ticks;
+  }
+
+  /**
+   * @brief Time-stamp counter on x86, steady clock nanoseconds elsewhere
+   */
+  static uint64_t
+  Now ()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc ();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+  }
+
+private:
+  ProfileSite &m_site;
+  uint64_t m_start;
+};
+#endif // NDN_HOTPATH_PROFILING
+
+class HotPathProfiler
+{
+public:
+  /**
+   * @brief Prints one row per site, grouped by component and sorted by total time:
+   * Component Site Count TotalMs MeanNs MaxNs. Ticks are converted to nanoseconds with
+   * the rate of the counter measured since the first site was registered.
+   */
+  static void
+  Print (std::ostream &os);
+
+  /**
+   * @brief Clears the aggregated timings, e.g., to leave out a warm-up period
+   */
+  static void
+  Reset ();
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* HOT_PATH_PROFILER_H_ */
@@ -1,4 +1,5 @@
 #include "interest-tracer.h"
+#include "metrics-registry.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/config.h"
@@ -14,6 +15,7 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
 #include <fstream>
 
 NS_LOG_COMPONENT_DEFINE ("ndn.InterestTracer");
@@ -23,6 +25,10 @@ using namespace std;
 namespace ns3 {
 namespace ndn {
 
+// headers of the text format, also stored in the columnar traces
+static const char *g_header = "Time\tNode\tType\tSignal\tValue\t";
+static const char *g_perFaceHeader = "Time\tNode\tFace\tType\tSignal\tValue\t";
+
 static std::list< boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<InterestTracer> > > > g_tracers;
 
 template<class T>
@@ -34,133 +40,116 @@ NullDeleter (T *ptr)
 void
 InterestTracer::Destroy ()
 {
+    for (std::list< boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<InterestTracer> > > >::iterator it = g_tracers.begin ();
+         it != g_tracers.end (); ++it)
+    {
+        std::list<Ptr<InterestTracer> > &tracers = it->get<1> ();
+        if (tracers.empty () || !tracers.front ()->m_sink)
+            continue;
+
+        boost::shared_ptr<AsyncTraceSink> sink = tracers.front ()->m_sink;
+        sink->Close ();
+        if (sink->GetDropped () > 0 || sink->GetBackpressure () > 0)
+            NS_LOG_WARN ("Trace sink: " << sink->GetWritten () << " records written, " << sink->GetDropped ()
+                         << " dropped, " << sink->GetBackpressure () << " waited for the writer");
+        else
+            NS_LOG_INFO ("Trace sink: " << sink->GetWritten () << " records written");
+    }
     g_tracers.clear ();
 }
 
-    void
-InterestTracer::InstallAll (const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/)
+// Opens the output of the tracers installed by one call of the file based installers:
+// the asynchronous sink, the columnar writer or the text stream, in this order
+    bool
+InterestTracer::OpenOutput (const std::string &file, Format format, bool async, bool perFace, Output &output)
 {
-    using namespace boost;
-    using namespace std;
-
-    std::list<Ptr<InterestTracer> > tracers;
-    boost::shared_ptr<std::ostream> outputStream;
-    if (file != "-")
+    if (async)
     {
-        boost::shared_ptr<std::ofstream> os (new std::ofstream ());
-        os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
-
-        if (!os->is_open ())
-        {
-            NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
-            return;
-        }
-
-        outputStream = os;
+        output.sink = OpenAsync (file, format, perFace);
+        return output.sink.get () != 0;
     }
-    else
+
+    if (format == FORMAT_COLUMNAR)
     {
-        outputStream = boost::shared_ptr<std::ostream> (&std::cout, NullDeleter<std::ostream>);
+        output.columnar = OpenColumnar (file, perFace);
+        return output.columnar.get () != 0;
     }
 
-    for (NodeList::Iterator node = NodeList::Begin ();
-            node != NodeList::End ();
-            node++)
+    if (file == "-")
     {
-        Ptr<InterestTracer> trace = Install (*node, outputStream, averagingPeriod);
-        tracers.push_back (trace);
+        output.stream = boost::shared_ptr<std::ostream> (&std::cout, NullDeleter<std::ostream>);
+        return true;
     }
 
-    if (tracers.size () > 0)
+    boost::shared_ptr<std::ofstream> os (new std::ofstream ());
+    os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+
+    if (!os->is_open ())
     {
-        tracers.front ()->PrintHeader (*outputStream);
-        *outputStream << "\n";
+        NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
+        return false;
     }
 
-    g_tracers.push_back (boost::make_tuple (outputStream, tracers));
+    output.stream = os;
+    return true;
 }
 
     void
-InterestTracer::Install (const NodeContainer &nodes, const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/)
+InterestTracer::InstallAll (const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/, Format format/* = FORMAT_TEXT*/, bool async/* = false*/,
+        bool perFace/* = false*/)
 {
-    using namespace boost;
-    using namespace std;
-
-    std::list<Ptr<InterestTracer> > tracers;
-    boost::shared_ptr<std::ostream> outputStream;
-    if (file != "-")
+    NodeContainer nodes;
+    for (NodeList::Iterator node = NodeList::Begin ();
+            node != NodeList::End ();
+            node++)
     {
-        boost::shared_ptr<std::ofstream> os (new std::ofstream ());
-        os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+        nodes.Add (*node);
+    }
 
-        if (!os->is_open ())
-        {
-            NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
-            return;
-        }
+    Install (nodes, file, averagingPeriod, format, async, perFace);
+}
 
-        outputStream = os;
-    }
-    else
-    {
-        outputStream = boost::shared_ptr<std::ostream> (&std::cout, NullDeleter<std::ostream>);
-    }
+    void
+InterestTracer::Install (const NodeContainer &nodes, const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/, Format format/* = FORMAT_TEXT*/, bool async/* = false*/,
+        bool perFace/* = false*/)
+{
+    Output output;
+    if (!OpenOutput (file, format, async, perFace, output))
+        return;
 
+    std::list<Ptr<InterestTracer> > tracers;
     for (NodeContainer::Iterator node = nodes.Begin ();
             node != nodes.End ();
             node++)
     {
-        Ptr<InterestTracer> trace = Install (*node, outputStream, averagingPeriod);
+        NS_LOG_DEBUG ("Node: " << (*node)->GetId ());
+
+        Ptr<InterestTracer> trace = Create<InterestTracer> (output.stream, *node);
+        if (perFace)
+            trace->EnablePerFace ();
+        if (output.sink)
+            trace->SetAsync (output.sink);
+        else if (output.columnar)
+            trace->SetColumnar (output.columnar);
         tracers.push_back (trace);
     }
 
-    if (tracers.size () > 0)
+    if (tracers.size () > 0 && output.stream)
     {
         // *m_l3RateTrace << "# "; // not necessary for R's read.table
-        tracers.front ()->PrintHeader (*outputStream);
-        *outputStream << "\n";
+        tracers.front ()->PrintHeader (*output.stream);
+        *output.stream << "\n";
     }
 
-    g_tracers.push_back (boost::make_tuple (outputStream, tracers));
+    g_tracers.push_back (boost::make_tuple (output.stream, tracers));
+    StartPrinting (averagingPeriod);
 }
 
     void
-InterestTracer::Install (Ptr<Node> node, const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/)
+InterestTracer::Install (Ptr<Node> node, const std::string &file, Time averagingPeriod/* = Seconds (0.5)*/, Format format/* = FORMAT_TEXT*/, bool async/* = false*/,
+        bool perFace/* = false*/)
 {
-    using namespace boost;
-    using namespace std;
-
-    std::list<Ptr<InterestTracer> > tracers;
-    boost::shared_ptr<std::ostream> outputStream;
-    if (file != "-")
-    {
-        boost::shared_ptr<std::ofstream> os (new std::ofstream ());
-        os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
-
-        if (!os->is_open ())
-        {
-            NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
-            return;
-        }
-
-        outputStream = os;
-    }
-    else
-    {
-        outputStream = boost::shared_ptr<std::ostream> (&std::cout, NullDeleter<std::ostream>);
-    }
-
-    Ptr<InterestTracer> trace = Install (node, outputStream, averagingPeriod);
-    tracers.push_back (trace);
-
-    if (tracers.size () > 0)
-    {
-        // *m_l3RateTrace << "# "; // not necessary for R's read.table
-        tracers.front ()->PrintHeader (*outputStream);
-        *outputStream << "\n";
-    }
-
-    g_tracers.push_back (boost::make_tuple (outputStream, tracers));
+    Install (NodeContainer (node), file, averagingPeriod, format, async, perFace);
 }
 
 
@@ -172,11 +161,39 @@ InterestTracer::Install (Ptr<Node> node,
     NS_LOG_DEBUG ("Node: " << node->GetId ());
 
     Ptr<InterestTracer> trace = Create<InterestTracer> (outputStream, node);
-    trace->SetAveragingPeriod (averagingPeriod);
+    g_tracers.push_back (boost::make_tuple (outputStream, std::list<Ptr<InterestTracer> > (1, trace)));
+    StartPrinting (averagingPeriod);
 
     return trace;
 }
 
+// The tracers print on the periodic event of the MetricsRegistry, instead of one event
+// per node, which is started with the period of the first tracers installed
+    void
+InterestTracer::StartPrinting (const Time &period)
+{
+    MetricsRegistry &registry = MetricsRegistry::Get ();
+    if (!registry.IsStarted ())
+        registry.Start (period);
+    else if (registry.GetPeriod () != period)
+        NS_LOG_WARN ("Averaging period " << period.GetSeconds () << "s ignored, the tracers print every "
+                     << registry.GetPeriod ().GetSeconds () << "s as the MetricsRegistry");
+
+    registry.AddPeriodic (MakeCallback (&InterestTracer::PrintAll));
+}
+
+    void
+InterestTracer::PrintAll ()
+{
+    for (std::list< boost::tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<InterestTracer> > > >::iterator it = g_tracers.begin ();
+         it != g_tracers.end (); ++it)
+    {
+        std::list<Ptr<InterestTracer> > &tracers = it->get<1> ();
+        for (std::list<Ptr<InterestTracer> >::iterator tracer = tracers.begin (); tracer != tracers.end (); ++tracer)
+            (*tracer)->PeriodicPrinter ();
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
@@ -184,6 +201,8 @@ InterestTracer::Install (Ptr<Node> node,
     InterestTracer::InterestTracer (boost::shared_ptr<std::ostream> os, Ptr<Node> node)
     : m_nodePtr (node)
       , m_os (os)
+      , m_perFace (false)
+      , m_currentFace (0)
 {
     m_node = boost::lexical_cast<string> (m_nodePtr->GetId ());
 
@@ -199,6 +218,8 @@ InterestTracer::Install (Ptr<Node> node,
     InterestTracer::InterestTracer (boost::shared_ptr<std::ostream> os, const std::string &node)
     : m_node (node)
       , m_os (os)
+      , m_perFace (false)
+      , m_currentFace (0)
 {
     Connect ();
 }
@@ -227,32 +248,101 @@ InterestTracer::Connect ()
   Reset();
 }
 
-
     void
-InterestTracer::SetAveragingPeriod (const Time &period)
+InterestTracer::EnablePerFace ()
 {
-    m_period = period;
-    m_printEvent.Cancel ();
-    m_printEvent = Simulator::Schedule (m_period, &InterestTracer::PeriodicPrinter, this);
+  if (m_perFace || stg_ptr == 0)
+    return;
+
+  m_perFace = true;
+  stg_ptr->TraceConnectWithoutContext ("InInterests", MakeCallback (&InterestTracer::InInterests, this));
 }
 
+
     void
 InterestTracer::PeriodicPrinter ()
 {
-    Print (*m_os);
+    if (m_columnar || m_sink)
+        Write ();
+    else
+        Print (*m_os);
     Reset ();
-
-    m_printEvent = Simulator::Schedule (m_period, &InterestTracer::PeriodicPrinter, this);
 }
 
 void
 InterestTracer::PrintHeader (std::ostream &os) const
 {
-    os << "Time" << "\t"
-        << "Node" << "\t"
-        << "Type" << "\t"
-        << "Signal" << "\t"
-        << "Value" << "\t";
+    os << GetHeader (m_perFace);
+}
+
+std::string
+InterestTracer::GetHeader (bool perFace)
+{
+    return perFace ? g_perFaceHeader : g_header;
+}
+
+std::vector<ColumnarKeyKind>
+InterestTracer::GetKeyKinds (bool perFace)
+{
+    std::vector<ColumnarKeyKind> keys;
+    keys.push_back (COLUMNAR_KEY_DICT); // Node
+    if (perFace)
+        keys.push_back (COLUMNAR_KEY_INT); // Face
+    keys.push_back (COLUMNAR_KEY_INT); // Type
+    keys.push_back (COLUMNAR_KEY_DICT); // Signal
+    return keys;
+}
+
+// The file is closed, and becomes readable, when the last tracer writing to it is
+// destroyed (see Destroy)
+boost::shared_ptr<ColumnarTraceWriter>
+InterestTracer::OpenColumnar (const std::string &file, bool perFace)
+{
+    boost::shared_ptr<ColumnarTraceWriter> writer (new ColumnarTraceWriter ());
+    if (file == "-" || !writer->Open (file, GetHeader (perFace), GetKeyKinds (perFace)))
+    {
+        NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
+        return boost::shared_ptr<ColumnarTraceWriter> ();
+    }
+    return writer;
+}
+
+// The writer thread is stopped, and the file closed, as the columnar writer above
+boost::shared_ptr<AsyncTraceSink>
+InterestTracer::OpenAsync (const std::string &file, Format format, bool perFace)
+{
+    boost::shared_ptr<AsyncTraceSink> sink (new AsyncTraceSink ());
+    if (file == "-" || !sink->Open (file, format == FORMAT_COLUMNAR, GetHeader (perFace), GetKeyKinds (perFace)))
+    {
+        NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Tracing disabled");
+        return boost::shared_ptr<AsyncTraceSink> ();
+    }
+    return sink;
+}
+
+template<class Output>
+void
+InterestTracer::InternKeys (Output &output)
+{
+    uint32_t signalColumn = m_perFace ? 3 : 2;
+    m_nodeKey = output.Intern (0, m_node);
+    m_signalKeys[0] = output.Intern (signalColumn, "Received");
+    m_signalKeys[1] = output.Intern (signalColumn, "Forwarded");
+    m_signalKeys[2] = output.Intern (signalColumn, "Dropped");
+}
+
+void
+InterestTracer::SetColumnar (boost::shared_ptr<ColumnarTraceWriter> writer)
+{
+    m_columnar = writer;
+    InternKeys (*writer);
+}
+
+void
+InterestTracer::SetAsync (boost::shared_ptr<AsyncTraceSink> sink)
+{
+    m_sink = sink;
+    InternKeys (*sink);
 }
 
 void
@@ -263,6 +353,13 @@ InterestTracer::Reset ()
     interest_report.forwarded = 0;
     interest_report.dropped = 0;
   }
+
+  for (uint32_t face : m_activeFaces){
+    m_faceReports[2 * face] = InterestReport ();
+    m_faceReports[2 * face + 1] = InterestReport ();
+    m_faceActive[face] = false;
+  }
+  m_activeFaces.clear ();
 }
 
 #define PRINTER(type, printName, fieldName)           \
@@ -272,11 +369,43 @@ InterestTracer::Reset ()
   << printName << "\t"                          \
   << fieldName << "\n";
 
+#define FACE_PRINTER(face, type, printName, fieldName)  \
+  os << time.ToDouble (Time::S) << "\t"         \
+  << m_node << "\t"                             \
+  << face << "\t"                               \
+  << type << "\t"                               \
+  << printName << "\t"                          \
+  << fieldName << "\n";
+
+// In per-face mode the node totals are printed with Face -1, followed by the faces
+// active during the period in increasing id order
 void
 InterestTracer::Print (std::ostream &os) const
 {
     Time time = Simulator::Now ();
 
+    if (m_perFace)
+    {
+        for (uint32_t type = 0; type < 2; type++)
+        {
+            FACE_PRINTER (-1, type, "Received", interest_reports[type].received);
+            FACE_PRINTER (-1, type, "Forwarded", interest_reports[type].forwarded);
+            FACE_PRINTER (-1, type, "Dropped", interest_reports[type].dropped);
+        }
+
+        std::vector<uint32_t> faces (m_activeFaces);
+        std::sort (faces.begin (), faces.end ());
+        for (uint32_t face : faces)
+            for (uint32_t type = 0; type < 2; type++)
+            {
+                const InterestReport &report = m_faceReports[2 * face + type];
+                FACE_PRINTER (face, type, "Received", report.received);
+                FACE_PRINTER (face, type, "Forwarded", report.forwarded);
+                FACE_PRINTER (face, type, "Dropped", report.dropped);
+            }
+        return;
+    }
+
     // Fake Interests
     PRINTER (0, "Received", interest_reports[0].received);
     PRINTER (0, "Forwarded", interest_reports[0].forwarded);
@@ -288,6 +417,53 @@ InterestTracer::Print (std::ostream &os) const
     PRINTER (1, "Dropped", interest_reports[1].dropped);
 }
 
+void
+InterestTracer::Emit (TraceRecord &record, int64_t face, const InterestReport &report) const
+{
+    // the Face column, if any, comes right after the Node one
+    uint32_t signalColumn = m_perFace ? 3 : 2;
+    if (m_perFace)
+        record.keys[1] = face;
+
+    const uint32_t *counters[3] = { &report.received, &report.forwarded, &report.dropped };
+    for (uint32_t signal = 0; signal < 3; signal++)
+    {
+        record.keys[signalColumn] = m_signalKeys[signal];
+        record.value = *counters[signal];
+        if (m_sink)
+            m_sink->Push (record);
+        else
+            m_columnar->Append (record.time, record.keys, record.value);
+    }
+}
+
+void
+InterestTracer::Write () const
+{
+    TraceRecord record;
+    record.time = Simulator::Now ().GetNanoSeconds ();
+    record.keys[0] = m_nodeKey;
+    uint32_t typeColumn = m_perFace ? 2 : 1;
+
+    for (uint32_t type = 0; type < 2; type++)
+    {
+        record.keys[typeColumn] = type;
+        Emit (record, -1, interest_reports[type]);
+    }
+
+    if (!m_perFace)
+        return;
+
+    std::vector<uint32_t> faces (m_activeFaces);
+    std::sort (faces.begin (), faces.end ());
+    for (uint32_t face : faces)
+        for (uint32_t type = 0; type < 2; type++)
+        {
+            record.keys[typeColumn] = type;
+            Emit (record, face, m_faceReports[2 * face + type]);
+        }
+}
+
 void InterestTracer::InterestTypes (uint32_t type, uint32_t reportType)
 {
     this->interest_reports[type].received++;
@@ -296,6 +472,33 @@ void InterestTracer::InterestTypes (uint32_t type, uint32_t reportType)
       this->interest_reports[type].forwarded++;
     else if ( reportType == 0 )
       this->interest_reports[type].dropped++;
+
+    if (!m_perFace)
+      return;
+
+    if (m_currentFace >= m_faceActive.size ())
+      {
+        m_faceActive.resize (m_currentFace + 1, false);
+        m_faceReports.resize (2 * (m_currentFace + 1));
+      }
+    if (!m_faceActive[m_currentFace])
+      {
+        m_faceActive[m_currentFace] = true;
+        m_activeFaces.push_back (m_currentFace);
+      }
+
+    InterestReport &report = m_faceReports[2 * m_currentFace + type];
+    report.received++;
+    if( reportType == 1 )
+      report.forwarded++;
+    else if ( reportType == 0 )
+      report.dropped++;
+}
+
+void
+InterestTracer::InInterests (Ptr<const Interest> interest, Ptr<const Face> face)
+{
+    m_currentFace = face->GetId ();
 }
 
 } // namespace ndn
@@ -4,11 +4,13 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 #include <ns3/nstime.h>
-#include <ns3/event-id.h>
 #include <ns3/node-container.h>
 
 #include "ns3/ndnSIM/model/fw/ndn-forwarding-strategy.h"
 
+#include "columnar-trace.h"
+#include "async-trace-sink.h"
+
 #include <boost/tuple/tuple.hpp>
 #include <boost/shared_ptr.hpp>
 #include <map>
@@ -38,53 +40,72 @@ typedef struct InterestReport {
 class InterestTracer : public SimpleRefCount<InterestTracer>
 {
 public:
+  /**
+   * @brief Output format of the file based installers: tab-separated text, or the
+   * binary columnar format of columnar-trace.h, which can be converted back to text
+   * with ColumnarTraceReader::PrintText (e.g., by columnar-trace-dump)
+   */
+  enum Format { FORMAT_TEXT, FORMAT_COLUMNAR };
+
   /**
    * @brief Helper method to install tracers on all simulation nodes
    *
    * @param file File to which traces will be written.  If filename is -, then std::out is used
-   * @param averagingPeriod How often data will be written into the trace file (default, every half second)
+   * @param averagingPeriod How often data will be written into the trace file (default, every half second), unless the MetricsRegistry already runs with another period
+   * @param format Output format (default, text)
+   * @param async When true the output is formatted and written by a background thread (see async-trace-sink.h)
+   * @param perFace When true the counters are also reported per incoming face, in an additional Face column
    *
    * @returns a tuple of reference to output stream and list of tracers. !!! Attention !!! This tuple needs to be preserved
    *          for the lifetime of simulation, otherwise SEGFAULTs are inevitable
    * 
    */
   static void
-  InstallAll (const std::string &file, Time averagingPeriod = Seconds (0.5));
+  InstallAll (const std::string &file, Time averagingPeriod = Seconds (0.5), Format format = FORMAT_TEXT, bool async = false,
+              bool perFace = false);
 
   /**
    * @brief Helper method to install tracers on the selected simulation nodes
    *
    * @param nodes Nodes on which to install tracer
    * @param file File to which traces will be written.  If filename is -, then std::out is used
-   * @param averagingPeriod How often data will be written into the trace file (default, every half second)
+   * @param averagingPeriod How often data will be written into the trace file (default, every half second), unless the MetricsRegistry already runs with another period
+   * @param format Output format (default, text)
+   * @param async When true the output is formatted and written by a background thread (see async-trace-sink.h)
+   * @param perFace When true the counters are also reported per incoming face, in an additional Face column
    *
    * @returns a tuple of reference to output stream and list of tracers. !!! Attention !!! This tuple needs to be preserved
    *          for the lifetime of simulation, otherwise SEGFAULTs are inevitable
    *
    */
   static void
-  Install (const NodeContainer &nodes, const std::string &file, Time averagingPeriod = Seconds (0.5));
+  Install (const NodeContainer &nodes, const std::string &file, Time averagingPeriod = Seconds (0.5), Format format = FORMAT_TEXT, bool async = false,
+           bool perFace = false);
 
   /**
    * @brief Helper method to install tracers on a specific simulation node
    *
    * @param nodes Nodes on which to install tracer
    * @param file File to which traces will be written.  If filename is -, then std::out is used
-   * @param averagingPeriod How often data will be written into the trace file (default, every half second)
+   * @param averagingPeriod How often data will be written into the trace file (default, every half second), unless the MetricsRegistry already runs with another period
+   * @param format Output format (default, text)
+   * @param async When true the output is formatted and written by a background thread (see async-trace-sink.h)
+   * @param perFace When true the counters are also reported per incoming face, in an additional Face column
    *
    * @returns a tuple of reference to output stream and list of tracers. !!! Attention !!! This tuple needs to be preserved
    *          for the lifetime of simulation, otherwise SEGFAULTs are inevitable
    *
    */
   static void
-  Install (Ptr<Node> node, const std::string &file, Time averagingPeriod = Seconds (0.5));
+  Install (Ptr<Node> node, const std::string &file, Time averagingPeriod = Seconds (0.5), Format format = FORMAT_TEXT, bool async = false,
+           bool perFace = false);
 
   /**
    * @brief Helper method to install tracers on a specific simulation node
    *
    * @param nodes Nodes on which to install tracer
    * @param outputStream Smart pointer to a stream
-   * @param averagingPeriod How often data will be written into the trace file (default, every half second)
+   * @param averagingPeriod How often data will be written into the trace file (default, every half second), unless the MetricsRegistry already runs with another period
    *
    * @returns a tuple of reference to output stream and list of tracers. !!! Attention !!! This tuple needs to be preserved
    *          for the lifetime of simulation, otherwise SEGFAULTs are inevitable
@@ -135,16 +156,68 @@ public:
    */
   void
   Print (std::ostream &os) const;
-  
+
 private:
+  static std::string
+  GetHeader (bool perFace);
+
+  static std::vector<ColumnarKeyKind>
+  GetKeyKinds (bool perFace);
+
+  static boost::shared_ptr<ColumnarTraceWriter>
+  OpenColumnar (const std::string &file, bool perFace);
+
+  static boost::shared_ptr<AsyncTraceSink>
+  OpenAsync (const std::string &file, Format format, bool perFace);
+
+  // output of the tracers installed by one call of the file based installers, only one
+  // of them is set
+  struct Output
+  {
+    boost::shared_ptr<std::ostream> stream;
+    boost::shared_ptr<ColumnarTraceWriter> columnar;
+    boost::shared_ptr<AsyncTraceSink> sink;
+  };
+
+  static bool
+  OpenOutput (const std::string &file, Format format, bool async, bool perFace, Output &output);
+
+  template<class Output>
+  void
+  InternKeys (Output &output);
+
+  void
+  Emit (TraceRecord &record, int64_t face, const InterestReport &report) const;
+
+  void
+  SetColumnar (boost::shared_ptr<ColumnarTraceWriter> writer);
+
+  void
+  SetAsync (boost::shared_ptr<AsyncTraceSink> sink);
+
+  /**
+   * @brief Append current trace data to the columnar writer or to the asynchronous sink
+   */
+  void
+  Write () const;
+
   void
   Connect ();
 
   void
   InterestTypes (uint32_t type, uint32_t reportType);
- 
+
+  void
+  InInterests (Ptr<const Interest> interest, Ptr<const Face> face);
+
   void
-  SetAveragingPeriod (const Time &period);
+  EnablePerFace ();
+ 
+  static void
+  StartPrinting (const Time &period);
+
+  static void
+  PrintAll ();
 
   void
   Reset ();
@@ -162,10 +235,23 @@ private:
   // This array only contains two elements, report about malicious interests in the '0' cell and legitimate ones in the '1' cell
   InterestReport interest_reports[2];
 
+  // Per-face mode: the same two reports per face, indexed by 2*faceId + type. The face
+  // of an Interest is the one of the last InInterests event, since the strategies report
+  // its type while processing it. Only the faces active during the period are printed
+  // and reset
+  bool m_perFace;
+  uint32_t m_currentFace;
+  std::vector<InterestReport> m_faceReports;
+  std::vector<bool> m_faceActive;
+  std::vector<uint32_t> m_activeFaces;
+
   boost::shared_ptr<std::ostream> m_os;
 
-  Time m_period;
-  EventId m_printEvent;
+  // columnar format or asynchronous output, in place of m_os
+  boost::shared_ptr<ColumnarTraceWriter> m_columnar;
+  boost::shared_ptr<AsyncTraceSink> m_sink;
+  int64_t m_nodeKey;
+  int64_t m_signalKeys[3]; // Received, Forwarded, Dropped
 };
 
 /**
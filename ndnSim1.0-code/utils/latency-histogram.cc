@@ -0,0 +1,93 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+namespace ndn {
+
+LatencyHistogram::LatencyHistogram ()
+  : m_count (0)
+  , m_max (0)
+  , m_maxValue ((uint64_t (1) << MAX_BITS) - 1)
+{
+  m_counts.resize (GetIndex (m_maxValue) + 1, 0);
+}
+
+void
+LatencyHistogram::Merge (const LatencyHistogram &other)
+{
+  for (size_t i = 0; i < m_counts.size (); i++)
+    m_counts[i] += other.m_counts[i];
+  m_count += other.m_count;
+  if (other.m_max > m_max)
+    m_max = other.m_max;
+}
+
+void
+LatencyHistogram::Reset ()
+{
+  if (m_count == 0)
+    return;
+  m_counts.assign (m_counts.size (), 0);
+  m_count = 0;
+  m_max = 0;
+}
+
+void
+LatencyHistogram::GetBucket (uint32_t index, uint64_t &lowest, uint64_t &width)
+{
+  if (index < SUB_BUCKETS)
+    {
+      lowest = index;
+      width = 1;
+      return;
+    }
+  uint32_t shift = (index - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+  uint64_t top = (index - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+  lowest = top << shift;
+  width = uint64_t (1) << shift;
+}
+
+uint64_t
+LatencyHistogram::GetPercentile (double q) const
+{
+  if (m_count == 0)
+    return 0;
+
+  uint64_t rank = std::max<uint64_t> ((uint64_t)std::ceil (q * m_count), 1);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          uint64_t lowest, width;
+          GetBucket (i, lowest, width);
+          // never above the largest value recorded
+          return std::min (lowest + width / 2, m_max);
+        }
+    }
+  return m_max;
+}
+
+} // namespace ndn
+} // namespace ns3
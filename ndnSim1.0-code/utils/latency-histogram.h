@@ -0,0 +1,112 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Log-linear (HDR-style) histogram of delays in microseconds
+ *
+ * Every power of two is split into SUB_BUCKETS/2 linear buckets, values below
+ * SUB_BUCKETS have a bucket each, so any value is known within 1/32 (about 3%) of
+ * itself. Delays up to 2^32 us (more than an hour) are covered by 896 buckets, longer
+ * ones are clamped. Recording is a couple of shifts and an increment, histograms of the
+ * same layout are merged by adding the buckets.
+ */
+class LatencyHistogram
+{
+public:
+  enum { SUB_BUCKET_BITS = 6, SUB_BUCKETS = 1 << SUB_BUCKET_BITS, MAX_BITS = 32 };
+
+  LatencyHistogram ();
+
+  /**
+   * @param delay microseconds
+   */
+  void
+  Record (uint64_t delay)
+  {
+    if (delay > m_maxValue)
+      delay = m_maxValue;
+    m_counts[GetIndex (delay)]++;
+    m_count++;
+    if (delay > m_max)
+      m_max = delay;
+  }
+
+  void
+  Merge (const LatencyHistogram &other);
+
+  void
+  Reset ();
+
+  uint64_t
+  GetCount () const { return m_count; }
+
+  uint64_t
+  GetMax () const { return m_max; }
+
+  /**
+   * @brief Value at quantile q in [0, 1], i.e. the middle of the bucket holding the
+   * ceil(q*count)-th smallest value, 0 if the histogram is empty
+   */
+  uint64_t
+  GetPercentile (double q) const;
+
+  static uint32_t
+  GetIndex (uint64_t value)
+  {
+    if (value < SUB_BUCKETS)
+      return value;
+    uint32_t shift = Log2 (value) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + ((value >> shift) - SUB_BUCKETS / 2);
+  }
+
+  /**
+   * @brief Smallest value of bucket index and width of the bucket
+   */
+  static void
+  GetBucket (uint32_t index, uint64_t &lowest, uint64_t &width);
+
+private:
+  static uint32_t
+  Log2 (uint64_t value)
+  {
+    uint32_t bits = 0;
+    while (value >>= 1)
+      bits++;
+    return bits;
+  }
+
+private:
+  std::vector<uint64_t> m_counts;
+  uint64_t m_count;
+  uint64_t m_max;
+  uint64_t m_maxValue;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* LATENCY_HISTOGRAM_H_ */
@@ -0,0 +1,114 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memory-accounting.h"
+#include "metrics-registry.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/callback.h"
+#include "ns3/ndn-pit.h"
+
+namespace ns3 {
+namespace ndn {
+
+MemoryUsage MemoryAccounting::m_usage[MEM_SUBSYSTEMS];
+
+static const char *g_names[MEM_SUBSYSTEMS] = {
+  "titles",
+  "attacker.fakes",
+  "client.inflight",
+  "poseidon.faces",
+  "poseidon.prefixes",
+  "stats.faces",
+  "pit"
+};
+
+// gauges of InstallMetrics, by subsystem
+static MetricGauge *g_live[MEM_SUBSYSTEMS];
+static MetricGauge *g_peak[MEM_SUBSYSTEMS];
+static MetricGauge *g_allocations[MEM_SUBSYSTEMS];
+static MetricGauge *g_deallocations[MEM_SUBSYSTEMS];
+static uint32_t g_pitEntryBytes = 0;
+
+const char *
+MemoryAccounting::GetName (MemorySubsystem subsystem)
+{
+  return g_names[subsystem];
+}
+
+void
+MemoryAccounting::SamplePit (uint32_t entryBytes)
+{
+  uint64_t entries = 0;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      Ptr<Pit> pit = (*node)->GetObject<Pit> ();
+      if (pit != 0)
+        entries += pit->GetSize ();
+    }
+  SetLive (MEM_PIT, entries * entryBytes);
+}
+
+static void
+CollectMemoryUsage ()
+{
+  MemoryAccounting::SamplePit (g_pitEntryBytes);
+  for (uint32_t s = 0; s < MEM_SUBSYSTEMS; s++)
+    {
+      const MemoryUsage &usage = MemoryAccounting::Get (MemorySubsystem (s));
+      g_live[s]->Set (usage.live);
+      g_peak[s]->Set (usage.peak);
+      g_allocations[s]->Set (usage.allocations);
+      g_deallocations[s]->Set (usage.deallocations);
+    }
+}
+
+void
+MemoryAccounting::InstallMetrics (uint32_t pitEntryBytes/* = 192*/)
+{
+  MetricsRegistry &registry = MetricsRegistry::Get ();
+  for (uint32_t s = 0; s < MEM_SUBSYSTEMS; s++)
+    {
+      MetricLabels labels (1, std::make_pair (std::string ("subsystem"), std::string (g_names[s])));
+      g_live[s] = registry.AddGauge ("memory.live", labels);
+      g_peak[s] = registry.AddGauge ("memory.peak", labels);
+      g_allocations[s] = registry.AddGauge ("memory.allocations", labels);
+      g_deallocations[s] = registry.AddGauge ("memory.deallocations", labels);
+    }
+  g_pitEntryBytes = pitEntryBytes;
+  registry.AddCollector (MakeCallback (&CollectMemoryUsage));
+}
+
+void
+MemoryAccounting::Print (std::ostream &os)
+{
+  os << "Subsystem\tLiveBytes\tPeakBytes\tAllocations\tDeallocations\n";
+  for (uint32_t s = 0; s < MEM_SUBSYSTEMS; s++)
+    {
+      const MemoryUsage &usage = m_usage[s];
+      os << g_names[s] << "\t"
+         << usage.live << "\t"
+         << usage.peak << "\t"
+         << usage.allocations << "\t"
+         << usage.deallocations << "\n";
+    }
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,195 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORY_ACCOUNTING_H_
+#define MEMORY_ACCOUNTING_H_
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+/*
+ * Memory taken by the large data structures of the simulation, by subsystem.
+ *
+ * Containers declared with an AccountingAllocator report each allocation of their
+ * nodes and arrays to the subsystem of the allocator. The heap buffers of the strings
+ * they hold are not seen by the allocator, so the owners report them with
+ * MemoryAccounting::Allocate/Deallocate (StringBytes) when they insert and erase.
+ * The PIT belongs to ndnSIM, hence its memory is sampled from the number of entries
+ * when the usage is reported instead of being tracked allocation by allocation.
+ */
+
+namespace ns3 {
+namespace ndn {
+
+enum MemorySubsystem
+{
+  MEM_TITLE_CATALOG = 0, // WikiPageTitles
+  MEM_FAKE_LISTS,        // lists of fake names of the attackers
+  MEM_CLIENT_INFLIGHT,   // sequence numbers in flight and to be retransmitted of the consumers
+  MEM_POSEIDON_FACES,    // per-face state of Poseidon, its per-face counters included
+  MEM_POSEIDON_PREFIXES, // per (face, prefix) statistics of Poseidon
+  MEM_FACE_STATS,        // per-face counters of the other strategies
+  MEM_PIT,               // PIT entries of all the nodes, sampled
+  MEM_SUBSYSTEMS
+};
+
+struct MemoryUsage
+{
+  uint64_t live; // bytes
+  uint64_t peak;
+  uint64_t allocations;
+  uint64_t deallocations;
+};
+
+class MemoryAccounting
+{
+public:
+  static void
+  Allocate (MemorySubsystem subsystem, uint64_t bytes)
+  {
+    MemoryUsage &usage = m_usage[subsystem];
+    usage.live += bytes;
+    usage.allocations++;
+    if (usage.live > usage.peak)
+      usage.peak = usage.live;
+  }
+
+  static void
+  Deallocate (MemorySubsystem subsystem, uint64_t bytes)
+  {
+    MemoryUsage &usage = m_usage[subsystem];
+    usage.live -= bytes;
+    usage.deallocations++;
+  }
+
+  /**
+   * @brief Live bytes of a subsystem which is sampled rather than tracked
+   */
+  static void
+  SetLive (MemorySubsystem subsystem, uint64_t bytes)
+  {
+    MemoryUsage &usage = m_usage[subsystem];
+    usage.live = bytes;
+    if (usage.live > usage.peak)
+      usage.peak = usage.live;
+  }
+
+  /**
+   * @brief Bytes of the heap buffer of a string, 0 for the short ones stored inside
+   * the string object (the small string optimization of libstdc++ holds up to 15 chars)
+   */
+  static uint64_t
+  StringBytes (const std::string &value)
+  {
+    return value.capacity () > 15 ? value.capacity () + 1 : 0;
+  }
+
+  static const MemoryUsage &
+  Get (MemorySubsystem subsystem) { return m_usage[subsystem]; }
+
+  static const char *
+  GetName (MemorySubsystem subsystem);
+
+  /**
+   * @brief Estimates the memory of the PIT entries of all the nodes
+   *
+   * @param entryBytes Bytes of an entry, name included
+   */
+  static void
+  SamplePit (uint32_t entryBytes);
+
+  /**
+   * @brief Reports the usage through the MetricsRegistry at every snapshot, as the
+   * gauges memory.live, memory.peak, memory.allocations and memory.deallocations
+   * labelled with the subsystem
+   *
+   * @param pitEntryBytes Bytes of a PIT entry, the default is the estimate of Poseidon
+   * for a 64 bytes name
+   */
+  static void
+  InstallMetrics (uint32_t pitEntryBytes = 192);
+
+  /**
+   * @brief Prints one row per subsystem: Subsystem LiveBytes PeakBytes Allocations Deallocations
+   */
+  static void
+  Print (std::ostream &os);
+
+private:
+  // zero-initialized before any constructor runs, so that the containers of static
+  // objects can be accounted too
+  static MemoryUsage m_usage[MEM_SUBSYSTEMS];
+};
+
+/**
+ * @brief std::allocator reporting the memory it hands out to a subsystem
+ */
+template<class T, MemorySubsystem S>
+class AccountingAllocator : public std::allocator<T>
+{
+public:
+  template<class U>
+  struct rebind
+  {
+    typedef AccountingAllocator<U, S> other;
+  };
+
+  AccountingAllocator () { }
+
+  AccountingAllocator (const AccountingAllocator &) { }
+
+  template<class U>
+  AccountingAllocator (const AccountingAllocator<U, S> &) { }
+
+  T *
+  allocate (std::size_t n, const void * = 0)
+  {
+    T *p = std::allocator<T>::allocate (n);
+    MemoryAccounting::Allocate (S, n * sizeof (T));
+    return p;
+  }
+
+  void
+  deallocate (T *p, std::size_t n)
+  {
+    MemoryAccounting::Deallocate (S, n * sizeof (T));
+    std::allocator<T>::deallocate (p, n);
+  }
+};
+
+template<class T, class U, MemorySubsystem S>
+inline bool
+operator== (const AccountingAllocator<T, S> &, const AccountingAllocator<U, S> &)
+{
+  return true;
+}
+
+template<class T, class U, MemorySubsystem S>
+inline bool
+operator!= (const AccountingAllocator<T, S> &, const AccountingAllocator<U, S> &)
+{
+  return false;
+}
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* MEMORY_ACCOUNTING_H_ */
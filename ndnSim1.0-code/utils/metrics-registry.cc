@@ -0,0 +1,350 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "metrics-registry.h"
+
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.MetricsRegistry");
+
+namespace ns3 {
+namespace ndn {
+
+static const char *g_header = "Time\tMetric\tLabels\tField\tValue\t";
+
+MetricHistogram::MetricHistogram (const std::vector<double> &bounds)
+  : m_bounds (bounds)
+  , m_counts (bounds.size () + 1, 0)
+  , m_sum (0)
+  , m_count (0)
+{
+  std::sort (m_bounds.begin (), m_bounds.end ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Sinks
+
+TextMetricsSink::TextMetricsSink (boost::shared_ptr<std::ostream> os)
+  : m_os (os)
+  , m_header (false)
+{
+}
+
+void
+TextMetricsSink::Begin (Time now)
+{
+  if (!m_header)
+    {
+      *m_os << g_header << "\n";
+      m_header = true;
+    }
+}
+
+void
+TextMetricsSink::Write (Time now, const MetricInfo &metric, const std::string &field, double value)
+{
+  *m_os << now.ToDouble (Time::S) << "\t"
+        << metric.name << "\t"
+        << metric.labelString << "\t"
+        << field << "\t";
+
+  // counters are printed as integers, as the tracers do
+  if (value == std::floor (value) && std::fabs (value) < 9.2e18)
+    *m_os << (int64_t)value << "\n";
+  else
+    *m_os << value << "\n";
+}
+
+AsyncMetricsSink::AsyncMetricsSink ()
+{
+}
+
+bool
+AsyncMetricsSink::Open (const std::string &file, bool columnar)
+{
+  std::vector<ColumnarKeyKind> keys (3, COLUMNAR_KEY_DICT); // Metric, Labels, Field
+  return m_sink.Open (file, columnar, g_header, keys);
+}
+
+void
+AsyncMetricsSink::Write (Time now, const MetricInfo &metric, const std::string &field, double value)
+{
+  if (metric.id >= m_metricKeys.size ())
+    {
+      m_metricKeys.resize (metric.id + 1, -1);
+      m_labelKeys.resize (metric.id + 1, -1);
+    }
+  if (m_metricKeys[metric.id] < 0)
+    {
+      m_metricKeys[metric.id] = m_sink.Intern (0, metric.name);
+      m_labelKeys[metric.id] = m_sink.Intern (1, metric.labelString);
+    }
+
+  TraceRecord record;
+  record.time = now.GetNanoSeconds ();
+  record.keys[0] = m_metricKeys[metric.id];
+  record.keys[1] = m_labelKeys[metric.id];
+  record.keys[2] = m_sink.Intern (2, field);
+  record.value = value;
+  m_sink.Push (record);
+}
+
+void
+AsyncMetricsSink::Close ()
+{
+  m_sink.Close ();
+  NS_LOG_INFO ("Metrics rows written " << m_sink.GetWritten () << ", delayed by backpressure " << m_sink.GetBackpressure ());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Registry
+
+MetricsRegistry::MetricsRegistry ()
+{
+}
+
+MetricsRegistry &
+MetricsRegistry::Get ()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricLabels
+MetricsRegistry::NodeLabels (uint32_t node)
+{
+  MetricLabels labels;
+  labels.push_back (std::make_pair (std::string ("node"), boost::lexical_cast<std::string> (node)));
+  return labels;
+}
+
+void
+MetricsRegistry::AddInfo (MetricInfo::Kind kind, const std::string &name, const MetricLabels &labels)
+{
+  MetricInfo info;
+  info.kind = kind;
+  info.name = name;
+  info.labels = labels;
+  info.id = m_metrics.size ();
+  for (MetricLabels::const_iterator label = labels.begin (); label != labels.end (); ++label)
+    {
+      if (label != labels.begin ())
+        info.labelString += ",";
+      info.labelString += label->first + "=" + label->second;
+    }
+
+  m_metrics.push_back (info);
+}
+
+MetricCounter *
+MetricsRegistry::AddCounter (const std::string &name, const MetricLabels &labels)
+{
+  AddInfo (MetricInfo::COUNTER, name, labels);
+  m_slots.push_back (m_counters.size ());
+  m_counters.push_back (MetricCounter ());
+  return &m_counters.back ();
+}
+
+MetricGauge *
+MetricsRegistry::AddGauge (const std::string &name, const MetricLabels &labels)
+{
+  AddInfo (MetricInfo::GAUGE, name, labels);
+  m_slots.push_back (m_gauges.size ());
+  m_gauges.push_back (MetricGauge ());
+  return &m_gauges.back ();
+}
+
+MetricHistogram *
+MetricsRegistry::AddHistogram (const std::string &name, const MetricLabels &labels, const std::vector<double> &bounds)
+{
+  AddInfo (MetricInfo::HISTOGRAM, name, labels);
+  m_slots.push_back (m_histograms.size ());
+  m_histograms.push_back (MetricHistogram (bounds));
+  return &m_histograms.back ();
+}
+
+LatencyHistogram *
+MetricsRegistry::AddLatency (const std::string &name, const MetricLabels &labels)
+{
+  // the node=all series is registered along with the first latency it merges
+  MetricLabels merged;
+  merged.push_back (std::make_pair (std::string ("node"), std::string ("all")));
+  for (MetricLabels::const_iterator label = labels.begin (); label != labels.end (); ++label)
+    if (label->first != "node")
+      merged.push_back (*label);
+
+  int32_t mergeSlot = -1;
+  for (const MetricInfo &metric : m_metrics)
+    if (metric.kind == MetricInfo::LATENCY && metric.name == name && metric.labels == merged)
+      mergeSlot = m_slots[metric.id];
+
+  if (mergeSlot < 0)
+    {
+      AddInfo (MetricInfo::LATENCY, name, merged);
+      mergeSlot = m_latencies.size ();
+      m_slots.push_back (mergeSlot);
+      m_latencies.push_back (LatencyHistogram ());
+      m_latencyMerge.push_back (-1);
+    }
+
+  AddInfo (MetricInfo::LATENCY, name, labels);
+  m_slots.push_back (m_latencies.size ());
+  m_latencies.push_back (LatencyHistogram ());
+  m_latencyMerge.push_back (mergeSlot);
+  return &m_latencies.back ();
+}
+
+void
+MetricsRegistry::AddSink (Ptr<MetricsSink> sink)
+{
+  m_sinks.push_back (sink);
+}
+
+void
+MetricsRegistry::AddCollector (Callback<void> collector)
+{
+  m_collectors.push_back (collector);
+}
+
+void
+MetricsRegistry::AddPeriodic (Callback<void> callback)
+{
+  for (std::vector<Callback<void> >::iterator periodic = m_periodics.begin (); periodic != m_periodics.end (); ++periodic)
+    if (periodic->IsEqual (callback))
+      return;
+  m_periodics.push_back (callback);
+}
+
+void
+MetricsRegistry::Start (Time period)
+{
+  m_period = period;
+  m_flushEvent.Cancel ();
+  m_flushEvent = Simulator::Schedule (m_period, &MetricsRegistry::PeriodicFlush, this);
+}
+
+void
+MetricsRegistry::PeriodicFlush ()
+{
+  Flush ();
+  for (std::vector<Callback<void> >::iterator periodic = m_periodics.begin (); periodic != m_periodics.end (); ++periodic)
+    (*periodic) ();
+  m_flushEvent = Simulator::Schedule (m_period, &MetricsRegistry::PeriodicFlush, this);
+}
+
+void
+MetricsRegistry::Flush ()
+{
+  if (m_sinks.empty ())
+    return;
+
+  for (std::vector<Callback<void> >::iterator collector = m_collectors.begin (); collector != m_collectors.end (); ++collector)
+    (*collector) ();
+
+  Time now = Simulator::Now ();
+  for (std::vector<Ptr<MetricsSink> >::iterator sink = m_sinks.begin (); sink != m_sinks.end (); ++sink)
+    (*sink)->Begin (now);
+
+  for (uint32_t slot = 0; slot < m_latencies.size (); slot++)
+    if (m_latencyMerge[slot] >= 0)
+      m_latencies[m_latencyMerge[slot]].Merge (m_latencies[slot]);
+
+  for (const MetricInfo &metric : m_metrics)
+    for (std::vector<Ptr<MetricsSink> >::iterator sink = m_sinks.begin (); sink != m_sinks.end (); ++sink)
+      {
+        switch (metric.kind)
+          {
+          case MetricInfo::COUNTER:
+            (*sink)->Write (now, metric, "value", m_counters[m_slots[metric.id]].Get ());
+            break;
+          case MetricInfo::GAUGE:
+            (*sink)->Write (now, metric, "value", m_gauges[m_slots[metric.id]].Get ());
+            break;
+          case MetricInfo::HISTOGRAM:
+            {
+              const MetricHistogram &histogram = m_histograms[m_slots[metric.id]];
+              (*sink)->Write (now, metric, "count", histogram.GetCount ());
+              (*sink)->Write (now, metric, "sum", histogram.GetSum ());
+              // cumulative buckets, so that any quantile can be read from a single snapshot
+              uint64_t cumulative = 0;
+              for (uint32_t i = 0; i < histogram.GetBounds ().size (); i++)
+                {
+                  cumulative += histogram.GetBucket (i);
+                  (*sink)->Write (now, metric, "le=" + boost::lexical_cast<std::string> (histogram.GetBounds ()[i]), cumulative);
+                }
+              (*sink)->Write (now, metric, "le=inf", histogram.GetCount ());
+              break;
+            }
+          case MetricInfo::LATENCY:
+            WriteLatency (*sink, now, metric, m_latencies[m_slots[metric.id]]);
+            break;
+          }
+      }
+
+  for (std::deque<LatencyHistogram>::iterator latency = m_latencies.begin (); latency != m_latencies.end (); ++latency)
+    latency->Reset ();
+
+  for (std::vector<Ptr<MetricsSink> >::iterator sink = m_sinks.begin (); sink != m_sinks.end (); ++sink)
+    (*sink)->End (now);
+}
+
+void
+MetricsRegistry::WriteLatency (Ptr<MetricsSink> sink, Time now, const MetricInfo &metric, const LatencyHistogram &latency)
+{
+  sink->Write (now, metric, "count", latency.GetCount ());
+  if (latency.GetCount () == 0)
+    return;
+
+  // microseconds to seconds
+  sink->Write (now, metric, "p50", latency.GetPercentile (0.5) / 1e6);
+  sink->Write (now, metric, "p90", latency.GetPercentile (0.9) / 1e6);
+  sink->Write (now, metric, "p99", latency.GetPercentile (0.99) / 1e6);
+  sink->Write (now, metric, "p99.9", latency.GetPercentile (0.999) / 1e6);
+  sink->Write (now, metric, "max", latency.GetMax () / 1e6);
+}
+
+void
+MetricsRegistry::Destroy ()
+{
+  MetricsRegistry &registry = Get ();
+  if (registry.m_flushEvent.IsRunning ())
+    registry.Flush ();
+  registry.m_flushEvent.Cancel ();
+
+  for (std::vector<Ptr<MetricsSink> >::iterator sink = registry.m_sinks.begin (); sink != registry.m_sinks.end (); ++sink)
+    (*sink)->Close ();
+  registry.m_sinks.clear ();
+  registry.m_collectors.clear ();
+  registry.m_periodics.clear ();
+
+  registry.m_metrics.clear ();
+  registry.m_slots.clear ();
+  registry.m_counters.clear ();
+  registry.m_gauges.clear ();
+  registry.m_histograms.clear ();
+  registry.m_latencies.clear ();
+  registry.m_latencyMerge.clear ();
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,331 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef METRICS_REGISTRY_H_
+#define METRICS_REGISTRY_H_
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+#include "ns3/callback.h"
+
+#include "async-trace-sink.h"
+#include "latency-histogram.h"
+
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Label set of a metric, e.g., (node, 3) (face, 256)
+ */
+typedef std::vector<std::pair<std::string, std::string> > MetricLabels;
+
+/**
+ * @brief Monotonic counter, never reset by the registry
+ */
+class MetricCounter
+{
+public:
+  MetricCounter () : m_value (0) { }
+
+  void
+  Inc (uint64_t n = 1) { m_value += n; }
+
+  uint64_t
+  Get () const { return m_value; }
+
+private:
+  uint64_t m_value;
+};
+
+/**
+ * @brief Last value of a quantity
+ */
+class MetricGauge
+{
+public:
+  MetricGauge () : m_value (0) { }
+
+  void
+  Set (double value) { m_value = value; }
+
+  void
+  Add (double delta) { m_value += delta; }
+
+  double
+  Get () const { return m_value; }
+
+private:
+  double m_value;
+};
+
+/**
+ * @brief Cumulative histogram over fixed bucket upper bounds, plus an overflow bucket
+ */
+class MetricHistogram
+{
+public:
+  MetricHistogram (const std::vector<double> &bounds);
+
+  void
+  Observe (double value)
+  {
+    m_counts[std::lower_bound (m_bounds.begin (), m_bounds.end (), value) - m_bounds.begin ()]++;
+    m_sum += value;
+    m_count++;
+  }
+
+  const std::vector<double> &
+  GetBounds () const { return m_bounds; }
+
+  /**
+   * @brief Observations of bucket i, i.e. in (bounds[i-1], bounds[i]], the last one is the overflow
+   */
+  uint64_t
+  GetBucket (uint32_t i) const { return m_counts[i]; }
+
+  uint64_t
+  GetCount () const { return m_count; }
+
+  double
+  GetSum () const { return m_sum; }
+
+private:
+  std::vector<double> m_bounds;
+  std::vector<uint64_t> m_counts;
+  double m_sum;
+  uint64_t m_count;
+};
+
+/**
+ * @brief Description of a registered metric, as passed to the sinks
+ */
+struct MetricInfo
+{
+  enum Kind { COUNTER, GAUGE, HISTOGRAM, LATENCY };
+
+  Kind kind;
+  std::string name;
+  MetricLabels labels;
+  std::string labelString; // labels formatted as k=v,k=v
+  uint32_t id; // registration order
+};
+
+/**
+ * @brief Destination of the snapshots of the registry
+ *
+ * Each snapshot is a sequence of Write calls, one per field of every metric (value for
+ * counters and gauges; count, sum and le=<bound> buckets for histograms; count, p50,
+ * p90, p99, p99.9 and max in seconds for latencies), enclosed by Begin and End.
+ */
+class MetricsSink : public SimpleRefCount<MetricsSink>
+{
+public:
+  virtual
+  ~MetricsSink () { }
+
+  virtual void
+  Begin (Time now) { }
+
+  virtual void
+  Write (Time now, const MetricInfo &metric, const std::string &field, double value) = 0;
+
+  virtual void
+  End (Time now) { }
+
+  /**
+   * @brief Called when the registry is destroyed
+   */
+  virtual void
+  Close () { }
+};
+
+/**
+ * @brief Tab-separated text rows: Time Metric Labels Field Value
+ */
+class TextMetricsSink : public MetricsSink
+{
+public:
+  TextMetricsSink (boost::shared_ptr<std::ostream> os);
+
+  virtual void
+  Begin (Time now);
+
+  virtual void
+  Write (Time now, const MetricInfo &metric, const std::string &field, double value);
+
+private:
+  boost::shared_ptr<std::ostream> m_os;
+  bool m_header;
+};
+
+/**
+ * @brief Rows of the text sink written by the background thread of an
+ * AsyncTraceSink, in text or in the columnar format
+ */
+class AsyncMetricsSink : public MetricsSink
+{
+public:
+  AsyncMetricsSink ();
+
+  bool
+  Open (const std::string &file, bool columnar);
+
+  virtual void
+  Write (Time now, const MetricInfo &metric, const std::string &field, double value);
+
+  virtual void
+  Close ();
+
+private:
+  AsyncTraceSink m_sink;
+  std::vector<int64_t> m_metricKeys; // by metric id: name, labels
+  std::vector<int64_t> m_labelKeys;
+};
+
+/**
+ * @brief Process-wide registry of counters, gauges and histograms
+ *
+ * Components register their metrics once (e.g., when they are started) and keep the
+ * returned pointers, which stay valid until Destroy, so that the hot path only does
+ * plain increments. A single event per period snapshots all the metrics to the sinks,
+ * instead of one periodic event per node and per component; the periodic output of
+ * other components can be driven by the same event (see AddPeriodic). Nothing is
+ * scheduled until Start is called, so metrics cost a memory write when nobody collects them.
+ */
+class MetricsRegistry
+{
+public:
+  static MetricsRegistry &
+  Get ();
+
+  MetricCounter *
+  AddCounter (const std::string &name, const MetricLabels &labels);
+
+  MetricGauge *
+  AddGauge (const std::string &name, const MetricLabels &labels);
+
+  MetricHistogram *
+  AddHistogram (const std::string &name, const MetricLabels &labels, const std::vector<double> &bounds);
+
+  /**
+   * @brief Latency histogram, reset at every snapshot
+   *
+   * Latencies with the same name and the same labels but the node are also merged at
+   * every snapshot into a series labelled node=all.
+   */
+  LatencyHistogram *
+  AddLatency (const std::string &name, const MetricLabels &labels);
+
+  void
+  AddSink (Ptr<MetricsSink> sink);
+
+  /**
+   * @brief Callback invoked before every snapshot, to refresh the gauges of values
+   * which are sampled rather than updated as they change
+   */
+  void
+  AddCollector (Callback<void> collector);
+
+  /**
+   * @brief Callback invoked after every periodic snapshot, even with no sink, for the
+   * periodic output which is not made of metrics (e.g., the rows of the per-node
+   * InterestTracers), so that it runs on the event of the registry instead of on one
+   * event per node. A callback already registered is not added again
+   */
+  void
+  AddPeriodic (Callback<void> callback);
+
+  /**
+   * @brief Schedules the periodic snapshot
+   */
+  void
+  Start (Time period);
+
+  bool
+  IsStarted () const { return m_flushEvent.IsRunning (); }
+
+  Time
+  GetPeriod () const { return m_period; }
+
+  /**
+   * @brief Takes a snapshot immediately
+   */
+  void
+  Flush ();
+
+  /**
+   * @brief Takes a last snapshot, closes the sinks and drops all the metrics, whose
+   * pointers become invalid
+   */
+  static void
+  Destroy ();
+
+  /**
+   * @brief Label set with the node id only, the most common one
+   */
+  static MetricLabels
+  NodeLabels (uint32_t node);
+
+  uint32_t
+  GetNMetrics () const { return m_metrics.size (); }
+
+private:
+  MetricsRegistry ();
+
+  void
+  AddInfo (MetricInfo::Kind kind, const std::string &name, const MetricLabels &labels);
+
+  void
+  PeriodicFlush ();
+
+  void
+  WriteLatency (Ptr<MetricsSink> sink, Time now, const MetricInfo &metric, const LatencyHistogram &latency);
+
+private:
+  std::vector<MetricInfo> m_metrics;
+  std::vector<uint32_t> m_slots; // by metric id: index in the container of its kind
+
+  // deques, so that the pointers handed out stay valid as metrics are added
+  std::deque<MetricCounter> m_counters;
+  std::deque<MetricGauge> m_gauges;
+  std::deque<MetricHistogram> m_histograms;
+  std::deque<LatencyHistogram> m_latencies;
+  std::vector<int32_t> m_latencyMerge; // by latency slot: slot of the node=all series, -1 for those
+
+  std::vector<Ptr<MetricsSink> > m_sinks;
+  std::vector<Callback<void> > m_collectors;
+  std::vector<Callback<void> > m_periodics;
+
+  Time m_period;
+  EventId m_flushEvent;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* METRICS_REGISTRY_H_ */
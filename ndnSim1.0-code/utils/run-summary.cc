@@ -0,0 +1,252 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "run-summary.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/names.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+#include "ns3/ndnSIM/model/fw/ndn-forwarding-strategy.h"
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.RunSummary");
+
+namespace ns3 {
+namespace ndn {
+
+static Ptr<RunSummary> g_summary;
+
+template<class T>
+static inline void
+NullDeleter (T *ptr)
+{
+}
+
+// NA, as R expects the missing values
+static void
+PrintValue (std::ostream &os, double value)
+{
+  if (value != value)
+    os << "\tNA";
+  else
+    os << "\t" << value;
+}
+
+static bool
+HasPrefix (const std::string &name, const char *prefix)
+{
+  return name.compare (0, std::char_traits<char>::length (prefix), prefix) == 0;
+}
+
+void
+RunSummary::InstallAll (const std::string &file, Time period/* = Seconds (10.0)*/, uint32_t pitSize/* = 0*/)
+{
+  boost::shared_ptr<std::ostream> outputStream;
+  if (file != "-")
+    {
+      boost::shared_ptr<std::ofstream> os (new std::ofstream ());
+      os->open (file.c_str (), std::ios_base::out | std::ios_base::trunc);
+
+      if (!os->is_open ())
+        {
+          NS_LOG_ERROR ("File " << file << " cannot be opened for writing. Summary disabled");
+          return;
+        }
+
+      outputStream = os;
+    }
+  else
+    outputStream = boost::shared_ptr<std::ostream> (&std::cout, NullDeleter<std::ostream>);
+
+  g_summary = Create<RunSummary> (outputStream, period, pitSize);
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    g_summary->Connect (*node);
+}
+
+void
+RunSummary::Destroy ()
+{
+  if (g_summary == 0)
+    return;
+
+  g_summary->m_sampleEvent.Cancel ();
+  g_summary->Print (*g_summary->m_os);
+  g_summary->m_os->flush ();
+  g_summary = 0;
+}
+
+RunSummary::RunSummary (boost::shared_ptr<std::ostream> os, Time period, uint32_t pitSize)
+  : m_os (os)
+  , m_period (period)
+  , m_pitSize (pitSize)
+{
+  m_current.satisfied = 0;
+  m_current.timedOut = 0;
+  m_current.legitReceived = 0;
+  m_current.legitDropped = 0;
+
+  m_sampleEvent = Simulator::Schedule (m_period, &RunSummary::PeriodicSample, this);
+}
+
+void
+RunSummary::Connect (Ptr<Node> node)
+{
+  Ptr<ForwardingStrategy> strategy = node->GetObject<ForwardingStrategy> ();
+  if (strategy == 0)
+    return;
+
+  std::string name = Names::FindName (node);
+  if (HasPrefix (name, "client"))
+    {
+      strategy->TraceConnectWithoutContext ("SatisfiedInterests", MakeCallback (&RunSummary::Satisfied, this));
+      strategy->TraceConnectWithoutContext ("TimedOutInterests", MakeCallback (&RunSummary::TimedOut, this));
+      return;
+    }
+  if (HasPrefix (name, "attacker") || HasPrefix (name, "server"))
+    return;
+
+  strategy->TraceConnectWithoutContext ("InterestTypes", MakeCallback (&RunSummary::InterestTypes, this));
+
+  Router router;
+  router.pit = node->GetObject<Pit> ();
+  if (router.pit == 0)
+    return;
+
+  if (m_pitSize != 0)
+    router.capacity = m_pitSize;
+  else
+    {
+      UintegerValue maxSize;
+      router.pit->GetAttribute ("MaxSize", maxSize);
+      router.capacity = maxSize.Get ();
+    }
+  router.monitor = HasPrefix (name, "monitor");
+  router.used = false;
+  m_routers.push_back (router);
+}
+
+void
+RunSummary::Satisfied (Ptr<const pit::Entry> entry)
+{
+  m_current.satisfied++;
+}
+
+void
+RunSummary::TimedOut (Ptr<const pit::Entry> entry)
+{
+  m_current.timedOut++;
+}
+
+void
+RunSummary::InterestTypes (uint32_t type, uint32_t reportType)
+{
+  // 1 legitimate, the report types are 1 forwarded, 0 dropped, anything else received
+  if (type != 1)
+    return;
+
+  m_current.legitReceived++;
+  if (reportType == 0)
+    m_current.legitDropped++;
+}
+
+void
+RunSummary::PeriodicSample ()
+{
+  m_current.time = Simulator::Now ();
+  m_current.entries.resize (m_routers.size ());
+  for (size_t r = 0; r < m_routers.size (); r++)
+    {
+      m_current.entries[r] = m_routers[r].pit->GetSize ();
+      if (m_current.entries[r] > 0)
+        m_routers[r].used = true;
+    }
+  m_periods.push_back (m_current);
+
+  m_current.satisfied = 0;
+  m_current.timedOut = 0;
+  m_current.legitReceived = 0;
+  m_current.legitDropped = 0;
+
+  m_sampleEvent = Simulator::Schedule (m_period, &RunSummary::PeriodicSample, this);
+}
+
+void
+RunSummary::Print (std::ostream &os) const
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN ();
+
+  // capacity of the routers whose PIT was used at some point
+  double monitorCapacity = 0, allCapacity = 0;
+  for (const Router &router : m_routers)
+    if (router.used)
+      {
+        allCapacity += router.capacity;
+        if (router.monitor)
+          monitorCapacity += router.capacity;
+      }
+
+  os << "Time\tClientISR\tMonitorPUR\tAllPUR\tLegitDropRate\n";
+
+  double sums[4] = { 0, 0, 0, 0 };
+  uint32_t counts[4] = { 0, 0, 0, 0 };
+  for (const Period &period : m_periods)
+    {
+      double monitorEntries = 0, allEntries = 0;
+      for (size_t r = 0; r < period.entries.size (); r++)
+        if (m_routers[r].used)
+          {
+            allEntries += period.entries[r];
+            if (m_routers[r].monitor)
+              monitorEntries += period.entries[r];
+          }
+
+      double values[4];
+      values[0] = period.satisfied + period.timedOut > 0 ? (double)period.satisfied / (period.satisfied + period.timedOut) : nan;
+      values[1] = monitorCapacity > 0 ? monitorEntries / monitorCapacity : nan;
+      values[2] = allCapacity > 0 ? allEntries / allCapacity : nan;
+      values[3] = period.legitReceived > 0 ? (double)period.legitDropped / period.legitReceived : nan;
+
+      os << period.time.ToDouble (Time::S);
+      for (uint32_t v = 0; v < 4; v++)
+        {
+          PrintValue (os, values[v]);
+          if (values[v] == values[v]) // not NaN
+            {
+              sums[v] += values[v];
+              counts[v]++;
+            }
+        }
+      os << "\n";
+    }
+
+  os << "# mean";
+  for (uint32_t v = 0; v < 4; v++)
+    PrintValue (os, counts[v] > 0 ? sums[v] / counts[v] : nan);
+  os << "\n";
+}
+
+} // namespace ndn
+} // namespace ns3
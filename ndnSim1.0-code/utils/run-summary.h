@@ -0,0 +1,135 @@
+/*
+Copyright (C) 2016, the University of Luxembourg
+Salvatore Signorello <salvatore.signorello@uni.lu>
+
+This is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This software is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RUN_SUMMARY_H_
+#define RUN_SUMMARY_H_
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include <ns3/nstime.h>
+#include <ns3/event-id.h>
+
+#include "ns3/ndn-pit.h"
+#include "ns3/ndn-pit-entry.h"
+
+#include <boost/shared_ptr.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+namespace ndn {
+
+/**
+ * @brief Online computation of the evaluation metrics of a run
+ *
+ * Computes, per period, the same values the Rplotting scripts derive from the L3 and
+ * PIT traces, and writes them as one small table at the end of the run:
+ *  - ClientISR: Satisfied/(Satisfied+TimedOut) Interests of the client nodes (isr.R)
+ *  - MonitorPUR, AllPUR: PIT entries over PIT capacity of the monitor nodes and of all
+ *    the routers, nodes whose PIT stays empty for the whole run being left out as
+ *    pitUsage.R -e does
+ *  - LegitDropRate: legitimate Interests dropped over the ones received by the routers,
+ *    as reported through the InterestTypes trace of the strategies
+ * Nodes are told apart by the names registered with Names::Add: client*, monitor*,
+ * while the routers are all the nodes not named client*, attacker* or server*.
+ *
+ * The run averages are written on a last line starting with '#', skipped by read.table.
+ */
+class RunSummary : public SimpleRefCount<RunSummary>
+{
+public:
+  /**
+   * @brief Installs the summary on all simulation nodes
+   *
+   * @param file File to which the summary will be written at the end of the run (Destroy)
+   * @param period Length of the periods, as the averaging period of the tracers replaced
+   * @param pitSize PIT capacity of every router, 0 to read the MaxSize of each PIT
+   */
+  static void
+  InstallAll (const std::string &file, Time period = Seconds (10.0), uint32_t pitSize = 0);
+
+  /**
+   * @brief Writes the summary and removes the installed instance
+   */
+  static void
+  Destroy ();
+
+  RunSummary (boost::shared_ptr<std::ostream> os, Time period, uint32_t pitSize);
+
+  /**
+   * @brief Prints the table computed so far
+   */
+  void
+  Print (std::ostream &os) const;
+
+private:
+  void
+  Connect (Ptr<Node> node);
+
+  void
+  Satisfied (Ptr<const pit::Entry> entry);
+
+  void
+  TimedOut (Ptr<const pit::Entry> entry);
+
+  void
+  InterestTypes (uint32_t type, uint32_t reportType);
+
+  void
+  PeriodicSample ();
+
+private:
+  struct Router
+  {
+    Ptr<Pit> pit;
+    double capacity;
+    bool monitor;
+    bool used; // the PIT held some entry in at least one sample
+  };
+
+  // raw values of a period, the ratios are computed when printing since the routers
+  // taken into account for the PUR are only known at the end of the run
+  struct Period
+  {
+    Time time;
+    uint64_t satisfied;
+    uint64_t timedOut;
+    std::vector<uint32_t> entries; // by router
+    uint64_t legitReceived;
+    uint64_t legitDropped;
+  };
+
+  boost::shared_ptr<std::ostream> m_os;
+  Time m_period;
+  uint32_t m_pitSize;
+
+  std::vector<Router> m_routers;
+  Period m_current;
+  std::vector<Period> m_periods;
+
+  EventId m_sampleEvent;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif /* RUN_SUMMARY_H_ */
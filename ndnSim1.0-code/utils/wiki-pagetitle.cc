@@ -20,6 +20,8 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <functional>
 
 
 WikiPageTitles* WikiPageTitles::m_pInstance = 0;
@@ -34,7 +36,7 @@ WikiPageTitles* WikiPageTitles::Instance()
 
 int32_t WikiPageTitles::find(std::string name)
 {
-  std::unordered_map<std::string,int32_t>::iterator it;
+  TitlesMap::iterator it;
 
   it = page_titles.find(name);
   if(it != page_titles.end())
@@ -57,9 +59,13 @@ void WikiPageTitles::load(std::string filename)
     std::pair<std::string,int32_t> entry (current_title,titles_index);
 
     // create an index only if no element with that key was present
-    if( page_titles.insert(entry).second ){
+    std::pair<TitlesMap::iterator,bool> inserted = page_titles.insert(entry);
+    if( inserted.second ){
       map_indexes.push_back(current_title);
       titles_index++;
+      // one copy in the map and one in the index
+      ns3::ndn::MemoryAccounting::Allocate(ns3::ndn::MEM_TITLE_CATALOG, ns3::ndn::MemoryAccounting::StringBytes((*inserted.first).first));
+      ns3::ndn::MemoryAccounting::Allocate(ns3::ndn::MEM_TITLE_CATALOG, ns3::ndn::MemoryAccounting::StringBytes(map_indexes.back()));
     }
   }
   titles_file.close();
@@ -75,13 +81,14 @@ uint32_t WikiPageTitles::size(){ return m_pageTitlesSize;}
 std::string WikiPageTitles::pickElement(uint32_t increment)
 {
   std::string result = "";
-  std::unordered_map<std::string,int32_t>::iterator it = page_titles.begin();
+  TitlesMap::iterator it = page_titles.begin();
   if(it != page_titles.end()){
     if (increment < m_pageTitlesSize )
       std::advance(it,increment); 
     else if (m_pageTitlesSize != 1)
       std::advance(it,1);
     result = (*it).first;
+    ns3::ndn::MemoryAccounting::Deallocate(ns3::ndn::MEM_TITLE_CATALOG, ns3::ndn::MemoryAccounting::StringBytes((*it).first));
     page_titles.erase(it);
   }
   return result;
@@ -92,3 +99,35 @@ std::string WikiPageTitles::readElement(uint32_t index)
 {
   return map_indexes[index % m_pageTitlesSize];
 }
+
+// the number of segments is a deterministic function of the title, in the range [1, maxSegments]
+uint32_t WikiPageTitles::segments(uint32_t index, uint32_t maxSegments)
+{
+  if (maxSegments <= 1)
+    return 1;
+
+  std::hash<std::string> hasher;
+  return 1 + (uint32_t)(hasher(readElement(index)) % maxSegments);
+}
+
+std::string WikiPageTitles::segmentComponent(uint32_t segment)
+{
+  std::ostringstream os;
+  os << "seg=" << segment;
+  return os.str();
+}
+
+// returns false if the component does not look like seg=N
+bool WikiPageTitles::parseSegment(const std::string &component, uint32_t &segment)
+{
+  if (component.size() <= 4 || component.compare(0, 4, "seg=") != 0)
+    return false;
+
+  char *end = 0;
+  unsigned long value = strtoul(component.c_str() + 4, &end, 10);
+  if (*end != '\0')
+    return false;
+
+  segment = (uint32_t) value;
+  return true;
+}
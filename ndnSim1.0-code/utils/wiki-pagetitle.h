@@ -24,6 +24,7 @@ along with this software.  If not, see <http://www.gnu.org/licenses/>.
 #include <unordered_map>
 #include <stdint.h>
 
+#include "memory-accounting.h"
 
 class WikiPageTitles
 {
@@ -35,14 +36,26 @@ public:
   std::string pickElement(uint32_t increment);
   std::string readElement(uint32_t index);
 
+  // Segmented objects: every title is split into a number of segments which
+  // is derived from the title itself, so that producers and consumers agree on
+  // it without any additional signaling. Segments are named /prefix/title/seg=N
+  uint32_t segments(uint32_t index, uint32_t maxSegments);
+  static std::string segmentComponent(uint32_t segment);
+  static bool parseSegment(const std::string &component, uint32_t &segment);
+
 private:
+  // accounted as the title catalog, the string buffers by load and pickElement
+  typedef ns3::ndn::AccountingAllocator<std::pair<const std::string,int32_t>, ns3::ndn::MEM_TITLE_CATALOG> TitlesAllocator;
+  typedef std::unordered_map<std::string,int32_t,std::hash<std::string>,std::equal_to<std::string>,TitlesAllocator> TitlesMap;
+  typedef std::vector<std::string,ns3::ndn::AccountingAllocator<std::string, ns3::ndn::MEM_TITLE_CATALOG> > TitlesVector;
+
   WikiPageTitles (){};
   WikiPageTitles(WikiPageTitles const&);
   WikiPageTitles&  operator=(WikiPageTitles const&){};
   static WikiPageTitles* m_pInstance;
   uint32_t m_pageTitlesSize;
-  std::unordered_map<std::string,int32_t> page_titles;
-  std::vector<std::string> map_indexes;
+  TitlesMap page_titles;
+  TitlesVector map_indexes;
 };
 
 #endif